@@ -0,0 +1,44 @@
+#include "../Elements/Elements.h"
+#include "../TraceStats/TraceStats.h"
+#include "../Tools/Tools.h"
+
+using namespace std;
+
+// TDHeavyKeeper 插入吞吐量测试: ./sketch_bench <traces_file> [TopK] [rounds] [sketch_KB]
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cout << "usage: ./sketch_bench <traces_file> [TopK] [rounds] [sketch_KB]" << endl;
+        exit(0);
+    }
+    int topk = argc > 2 ? atoi(argv[2]) : 1000;
+    int rounds = argc > 3 ? atoi(argv[3]) : 10;
+    double sketch_kb = argc > 4 ? atof(argv[4]) : 0.4 * 1024;
+
+    vector<Trace> traces = LoadTraces(argv[1]);
+    int traces_num = traces.size();
+    vector<__uint128_t> keys(traces_num);
+    for (int i = 0; i < traces_num; ++i) {
+        keys[i] = traceTo128(&traces[i]);
+    }
+
+    struct timespec ts_start, ts_end;
+    double total_time = 0;
+    uint64_t topk_size = 0;
+    for (int r = 0; r < rounds; ++r) {
+        TDHeavyKeeper tdhk(topk, sketch_kb * 1024 / 16);
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        for (int i = 0; i < traces_num; ++i) {
+            tdhk.insert(keys[i]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        total_time += GetTimeInMicroSeconds(ts_start, ts_end);
+        topk_size += tdhk.work().size();
+    }
+
+    printf("traces_num:      %d\n", traces_num);
+    printf("rounds:          %d\n", rounds);
+    printf("avg_insert_time: %.8lf US\n", total_time / ((double)traces_num * rounds));
+    printf("insert_rate:     %.4lf Mpps\n", (double)traces_num * rounds / total_time);
+    printf("avg_topk_size:   %.1lf\n", (double)topk_size / rounds);
+    return 0;
+}
\ No newline at end of file
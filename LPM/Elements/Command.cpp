@@ -10,6 +10,18 @@ string Command::output_file = "";
 
 int Command::lookup_round = 0;  
 int Command::TopK = 0;   
+int Command::batch_size = 0;   
+int Command::prefetch_width = 0;   
+string Command::update_file = ""; 
+int Command::rcu_readers = 0;   
+int Command::threads = 0;   
+int Command::sketch_threads = 0;   
+int Command::window = 0;   
+int Command::reoptimize = 0;   
+string Command::snapshot_file = ""; 
+string Command::dump_traces = ""; 
+int Command::ring_size = 0;   
+int Command::latency_batch = 0;   
 
 bool Command::Set(int argc, char *argv[]) {
 	char short_opts[] = "";   
@@ -21,6 +33,18 @@ bool Command::Set(int argc, char *argv[]) {
         {"output_file",   required_argument, NULL, 5},  
         {"lookup_round",  required_argument, NULL, 6},  
         {"TopK",          required_argument, NULL, 7},
+        {"batch_size",    required_argument, NULL, 8},
+        {"prefetch_width",required_argument, NULL, 9},
+        {"update_file",   required_argument, NULL, 10},
+        {"rcu_readers",   required_argument, NULL, 11},
+        {"threads",       required_argument, NULL, 12},
+        {"sketch_threads",required_argument, NULL, 13},
+        {"window",        required_argument, NULL, 14},
+        {"reoptimize",    required_argument, NULL, 15},
+        {"snapshot_file", required_argument, NULL, 16},
+        {"dump_traces",   required_argument, NULL, 17},
+        {"ring_size",     required_argument, NULL, 18},
+        {"latency_batch", required_argument, NULL, 19},
         {0,               0,                 0,    0} 
     };
 
@@ -48,6 +72,42 @@ bool Command::Set(int argc, char *argv[]) {
         case 7:
             TopK = strtoul(optarg, NULL, 0);
             break;
+        case 8:
+            batch_size = strtoul(optarg, NULL, 0);
+            break;
+        case 9:
+            prefetch_width = strtoul(optarg, NULL, 0);
+            break;
+        case 10:
+            update_file = optarg;
+            break;
+        case 11:
+            rcu_readers = strtoul(optarg, NULL, 0);
+            break;
+        case 12:
+            threads = strtoul(optarg, NULL, 0);
+            break;
+        case 13:
+            sketch_threads = strtoul(optarg, NULL, 0);
+            break;
+        case 14:
+            window = strtoul(optarg, NULL, 0);
+            break;
+        case 15:
+            reoptimize = strtoul(optarg, NULL, 0);
+            break;
+        case 16:
+            snapshot_file = optarg;
+            break;
+        case 17:
+            dump_traces = optarg;
+            break;
+        case 18:
+            ring_size = strtoul(optarg, NULL, 0);
+            break;
+        case 19:
+            latency_batch = strtoul(optarg, NULL, 0);
+            break;
         default:
             cout << "Wrong command " << opt << endl;
             exit(0);
@@ -16,6 +16,18 @@ public:
 
     static int lookup_round;   
     static int TopK;  
+    static int batch_size;  
+    static int prefetch_width;  
+    static string update_file;  
+    static int rcu_readers;  
+    static int threads;  
+    static int sketch_threads;  
+    static int window;  
+    static int reoptimize;  
+    static string snapshot_file;  
+    static string dump_traces;  
+    static int ring_size;  
+    static int latency_batch;  
 
     static bool Set(int argc, char *argv[]); 
 };
@@ -29,6 +29,7 @@ using namespace std;
 #include <cstdint>
 #include <limits>
 #include <fstream>
+#include <sstream>
 #include <thread>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -12,4 +12,9 @@ typedef struct Prefix {
     uint32_t port;
 }Prefix;
 
+typedef struct PrefixUpdate {
+    bool withdraw;
+    Prefix prefix;
+}PrefixUpdate;
+
 #endif
\ No newline at end of file
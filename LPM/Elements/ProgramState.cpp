@@ -34,7 +34,25 @@ ProgramState::ProgramState(){
     prefixs_num = traces_num = 0;         
 	rules_memory_size = traces_memory_size = sketch_memory_size = topk_tracesFreq_memory_size = TracesMat_memory_size = tree_memory_size = total_memory_size = 0;              
     sketch_build_and_update_time = sketch_calculate_topk_time = topk_tracesMat_init_time = rules_analyze_time = tree_build_time = total_build_time = 0; 
-    throughput = 0;
+    load_time = snapshot_load_time = snapshot_save_time = snapshot_size = 0;
+    throughput = batch_throughput = prefetch_throughput = prefetch_gain = 0;
+    ring_size = 0;
+    ring_throughput = 0;
+    latency_batch = 0;
+    latency_samples = latency_overhead = latency_p50 = latency_p90 = latency_p99 = latency_p999 = latency_max = 0;
+    updates_num = 0;
+    avg_update_time = max_update_time = 0;
+    rcu_readers = rcu_publish_num = 0;
+    rcu_avg_publish_time = rcu_avg_grace_time = rcu_throughput = 0;
+    rcu_reader_throughput.clear();
+    scaling_threads.clear();
+    scaling_throughput.clear();
+    scaling_efficiency.clear();
+    thread_throughput.clear();
+    window_size = window_num = window_rebuild_num = 0;
+    window_avg_drift = window_max_drift = window_last_drift = 0;
+    reopt_rounds = reopt_swaps = 0;
+    reopt_avg_build_time = reopt_current_access = reopt_candidate_access = reopt_reader_throughput = reopt_max_burst_time = 0;
 
     avg_insert_time = 0;
     avg_lookup_time = 0;
@@ -56,7 +74,25 @@ void ProgramState::Clear(){
 
 	rules_memory_size = traces_memory_size = sketch_memory_size = topk_tracesFreq_memory_size = TracesMat_memory_size = tree_memory_size = total_memory_size = 0;              
     sketch_build_and_update_time = sketch_calculate_topk_time = topk_tracesMat_init_time = rules_analyze_time = tree_build_time = total_build_time = 0; 
-    throughput = 0;
+    load_time = snapshot_load_time = snapshot_save_time = snapshot_size = 0;
+    throughput = batch_throughput = prefetch_throughput = prefetch_gain = 0;
+    ring_size = 0;
+    ring_throughput = 0;
+    latency_batch = 0;
+    latency_samples = latency_overhead = latency_p50 = latency_p90 = latency_p99 = latency_p999 = latency_max = 0;
+    updates_num = 0;
+    avg_update_time = max_update_time = 0;
+    rcu_readers = rcu_publish_num = 0;
+    rcu_avg_publish_time = rcu_avg_grace_time = rcu_throughput = 0;
+    rcu_reader_throughput.clear();
+    scaling_threads.clear();
+    scaling_throughput.clear();
+    scaling_efficiency.clear();
+    thread_throughput.clear();
+    window_size = window_num = window_rebuild_num = 0;
+    window_avg_drift = window_max_drift = window_last_drift = 0;
+    reopt_rounds = reopt_swaps = 0;
+    reopt_avg_build_time = reopt_current_access = reopt_candidate_access = reopt_reader_throughput = reopt_max_burst_time = 0;
 
     avg_insert_time = 0;
     avg_lookup_time = 0;
@@ -92,16 +128,92 @@ void ProgramState::Print(){
     fprintf(fp, "tree_memory_size:            %.8lf MB\n", tree_memory_size);
     fprintf(fp, "total_memory_size:           %.8lf MB\n\n", total_memory_size);
 
+    fprintf(fp, "load_time:                    %.8lf S\n", load_time);
     fprintf(fp, "sketch_build_and_update_time: %.8lf S\n", sketch_build_and_update_time);
     fprintf(fp, "sketch_calculate_topk_time:   %.8lf S\n", sketch_calculate_topk_time);
     fprintf(fp, "topk_tracesMat_init_time:     %.8lf S\n", topk_tracesMat_init_time);
     fprintf(fp, "rules_analyze_time:           %.8lf S\n", rules_analyze_time);
     fprintf(fp, "tree_build_time:              %.8lf S\n", tree_build_time);
-    fprintf(fp, "total_build_time:             %.8lf S\n\n", total_build_time);
+    fprintf(fp, "total_build_time:             %.8lf S\n", total_build_time);
+    if (snapshot_load_time > 0 || snapshot_save_time > 0) {
+        fprintf(fp, "snapshot_load_time:           %.8lf S\n", snapshot_load_time);
+        fprintf(fp, "snapshot_save_time:           %.8lf S\n", snapshot_save_time);
+        fprintf(fp, "snapshot_size:                %.8lf MB\n", snapshot_size);
+    }
+    fprintf(fp, "\n");
 
     fprintf(fp, "avg_lookup_time  :        %.8lf\n", avg_lookup_time);
     fprintf(fp, "avg_insert_time:          %.8lf US\n", avg_insert_time);
-    fprintf(fp, "throughput:               %.8lf pps\n\n", throughput);
+    fprintf(fp, "throughput:               %.8lf pps\n", throughput);
+    // 可选模式只在运行过时输出, 默认运行保持原有的输出格式
+    if (batch_throughput > 0) {
+        fprintf(fp, "batch_throughput:         %.8lf pps\n", batch_throughput);
+    }
+    if (prefetch_throughput > 0) {
+        fprintf(fp, "prefetch_throughput:      %.8lf pps\n", prefetch_throughput);
+        fprintf(fp, "prefetch_gain:            %.8lf x\n", prefetch_gain);
+    }
+    if (ring_size > 0) {
+        fprintf(fp, "ring_size:                %d\n", ring_size);
+        fprintf(fp, "ring_throughput:          %.8lf pps\n", ring_throughput);
+    }
+    fprintf(fp, "\n");
+
+    if (latency_samples > 0) {
+        fprintf(fp, "latency_batch:            %d\n", latency_batch);
+        fprintf(fp, "latency_samples:          %" PRIu64 "\n", latency_samples);
+        fprintf(fp, "latency_overhead:         %" PRIu64 " cycles\n", latency_overhead);
+        fprintf(fp, "latency_p50:              %" PRIu64 " cycles\n", latency_p50);
+        fprintf(fp, "latency_p90:              %" PRIu64 " cycles\n", latency_p90);
+        fprintf(fp, "latency_p99:              %" PRIu64 " cycles\n", latency_p99);
+        fprintf(fp, "latency_p99.9:            %" PRIu64 " cycles\n", latency_p999);
+        fprintf(fp, "latency_max:              %" PRIu64 " cycles\n\n", latency_max);
+    }
+
+    if (updates_num > 0) {
+        fprintf(fp, "updates_num:              %d\n", updates_num);
+        fprintf(fp, "avg_update_time:          %.8lf US\n", avg_update_time);
+        fprintf(fp, "max_update_time:          %.8lf US\n\n", max_update_time);
+    }
+
+    if (rcu_readers > 0) {
+        fprintf(fp, "rcu_readers:              %d\n", rcu_readers);
+        fprintf(fp, "rcu_publish_num:          %d\n", rcu_publish_num);
+        fprintf(fp, "rcu_avg_publish_time:     %.8lf US\n", rcu_avg_publish_time);
+        fprintf(fp, "rcu_avg_grace_time:       %.8lf US\n", rcu_avg_grace_time);
+        fprintf(fp, "rcu_throughput:           %.8lf pps\n", rcu_throughput);
+        for (size_t i = 0; i < rcu_reader_throughput.size(); ++i) {
+            fprintf(fp, "rcu_reader_%zu_throughput:  %.8lf pps\n", i, rcu_reader_throughput[i]);
+        }
+        fprintf(fp, "\n");
+    }
+
+    for (size_t i = 0; i < scaling_threads.size(); ++i) {
+        fprintf(fp, "threads_%d_throughput:      %.8lf pps (efficiency %.4lf)\n", scaling_threads[i], scaling_throughput[i], scaling_efficiency[i]);
+    }
+    for (size_t i = 0; i < thread_throughput.size(); ++i) {
+        fprintf(fp, "thread_%zu_throughput:      %.8lf pps\n", i, thread_throughput[i]);
+    }
+    if (!scaling_threads.empty()) fprintf(fp, "\n");
+
+    if (window_num > 0) {
+        fprintf(fp, "window_size:              %d\n", window_size);
+        fprintf(fp, "window_num:               %d\n", window_num);
+        fprintf(fp, "window_rebuild_num:       %d\n", window_rebuild_num);
+        fprintf(fp, "window_avg_drift:         %.8lf\n", window_avg_drift);
+        fprintf(fp, "window_max_drift:         %.8lf\n", window_max_drift);
+        fprintf(fp, "window_last_drift:        %.8lf\n\n", window_last_drift);
+    }
+
+    if (reopt_rounds > 0) {
+        fprintf(fp, "reopt_rounds:             %d\n", reopt_rounds);
+        fprintf(fp, "reopt_swaps:              %d\n", reopt_swaps);
+        fprintf(fp, "reopt_avg_build_time:     %.8lf US\n", reopt_avg_build_time);
+        fprintf(fp, "reopt_current_access:     %.8lf\n", reopt_current_access);
+        fprintf(fp, "reopt_candidate_access:   %.8lf\n", reopt_candidate_access);
+        fprintf(fp, "reopt_reader_throughput:  %.8lf pps\n", reopt_reader_throughput);
+        fprintf(fp, "reopt_max_burst_time:     %.8lf US\n\n", reopt_max_burst_time);
+    }
 
     fprintf(fp, "avg_lookup_access:        %.8lf\n", avg_lookup_access);
     fprintf(fp, "max_lookup_access:        %.0lf\n", max_lookup_access);
@@ -34,16 +34,65 @@ public:
 	double tree_memory_size;                
 	double total_memory_size;               
 
+	double load_time;
 	double sketch_build_and_update_time;    
 	double sketch_calculate_topk_time;      
 	double topk_tracesMat_init_time;        
 	double rules_analyze_time;              
 	double tree_build_time;                 
 	double total_build_time;               
+	double snapshot_load_time;
+	double snapshot_save_time;
+	double snapshot_size;
 
 	double avg_lookup_time;
 	double avg_insert_time;
 	double throughput;
+	double batch_throughput;
+	double prefetch_throughput;
+	double prefetch_gain;
+	int ring_size;
+	double ring_throughput;
+
+	int latency_batch;
+	uint64_t latency_samples;
+	uint64_t latency_overhead;
+	uint64_t latency_p50;
+	uint64_t latency_p90;
+	uint64_t latency_p99;
+	uint64_t latency_p999;
+	uint64_t latency_max;
+
+	int updates_num;
+	double avg_update_time;
+	double max_update_time;
+
+	int rcu_readers;
+	int rcu_publish_num;
+	double rcu_avg_publish_time;
+	double rcu_avg_grace_time;
+	double rcu_throughput;
+	vector<double> rcu_reader_throughput;
+
+	vector<int> scaling_threads;
+	vector<double> scaling_throughput;
+	vector<double> scaling_efficiency;
+	vector<double> thread_throughput;
+
+	int window_size;
+	int window_num;
+	int window_rebuild_num;
+	double window_avg_drift;
+	double window_max_drift;
+	double window_last_drift;
+
+	int reopt_rounds;
+	int reopt_swaps;
+	double reopt_avg_build_time;
+	double reopt_current_access;
+	double reopt_candidate_access;
+	double reopt_reader_throughput;
+	double reopt_max_burst_time;
 
 	CountState lookup_access_entry;         
 	CountState lookup_access;				
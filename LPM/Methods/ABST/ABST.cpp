@@ -94,6 +94,7 @@ void ABST_insert_prefix(AbstNode* root, AbstTrieNode* aux, Entry entry) {
 ABST::ABST(){
     root = NULL;
     aux = NULL;
+    snapshot = NULL;
 }
 
 void ABST::Create(vector<Prefix*> &prefixs, ProgramState *ps){
@@ -239,6 +240,53 @@ uint32_t ABST::Lookup(Trace *trace){
     return result;
 }
 
+void abst_lookup_batch(AbstNode* root, const Trace* traces, size_t n, uint32_t* out) {
+    __uint128_t ip[LOOKUP_BATCH_WIDTH];
+    AbstNode* node[LOOKUP_BATCH_WIDTH];
+    uint32_t result[LOOKUP_BATCH_WIDTH];
+
+    for (size_t base = 0; base < n; base += LOOKUP_BATCH_WIDTH) {
+        const size_t cnt = min((size_t)LOOKUP_BATCH_WIDTH, n - base);
+        for (size_t i = 0; i < cnt; ++i) {
+            ip[i] = ((__uint128_t)traces[base + i].ip6_upper << 64) | traces[base + i].ip6_lower;
+            node[i] = root;
+            result[i] = 0;
+        }
+
+        size_t active = root ? cnt : 0;
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                if (node[i] == NULL) continue;
+
+                Entry* temp = HashTable_lookup(node[i]->table, trim_prefix(ip[i], node[i]->prefix_len));
+                if (temp == NULL) {
+                    node[i] = node[i]->left;
+                } else {
+                    bool markey_hit = (temp->label & MARKER) != 0;
+                    bool prefix_hit = (temp->label & PREFIX) != 0;
+
+                    if (markey_hit && prefix_hit) {
+                        result[i] = temp->port;
+                        node[i] = node[i]->right;
+                    } else if (markey_hit) {
+                        result[i] = temp->bmp->port;
+                        node[i] = node[i]->right;
+                    } else {
+                        result[i] = temp->port;
+                        node[i] = NULL;
+                    }
+                }
+                if (node[i] != NULL) active++;
+            }
+        }
+
+        for (size_t i = 0; i < cnt; ++i) {
+            out[base + i] = result[i];
+        }
+    }
+}
+
 uint64_t calculateAbstNodeMemory(AbstNode* node) {
     if (node == nullptr) {
         return 0;
@@ -258,6 +306,70 @@ uint64_t calculateAbstNodeMemory(AbstNode* node) {
     return total;
 }
 
+// 快照只保存查找用到的 AbstNode 树、哈希表和 marker 指向的 bmp 表项, 辅助 trie 只在构建时使用
+uint64_t save_hash_table(SnapshotWriter &writer, const HashTable* table, unordered_map<const Entry*, uint64_t> &bmps) {
+    uint64_t table_off = writer.Append(table, sizeof(HashTable));
+    uint64_t ctrl_off = writer.Append(table->ctrl, table->bucket_size);
+    uint64_t slots_off = writer.Append(table->slots, (size_t)table->bucket_size * sizeof(Entry));
+    writer.SetPointer(table_off + offsetof(HashTable, ctrl), ctrl_off);
+    writer.SetPointer(table_off + offsetof(HashTable, slots), slots_off);
+
+    for (int i = 0; i < table->bucket_size; ++i) {
+        uint64_t field = slots_off + (uint64_t)i * sizeof(Entry) + offsetof(Entry, bmp);
+        const Entry* bmp = table->slots[i].bmp;
+        if (table->ctrl[i] == HASH_CTRL_EMPTY || bmp == NULL) {
+            *writer.At<uint64_t>(field) = 0;
+            continue;
+        }
+        auto it = bmps.find(bmp);
+        if (it == bmps.end()) {
+            uint64_t bmp_off = writer.Append(bmp, sizeof(Entry));
+            *writer.At<uint64_t>(bmp_off + offsetof(Entry, bmp)) = 0;
+            it = bmps.insert({bmp, bmp_off}).first;
+        }
+        writer.SetPointer(field, it->second);
+    }
+    return table_off;
+}
+
+uint64_t save_abst_node(SnapshotWriter &writer, const AbstNode* node, unordered_map<const Entry*, uint64_t> &bmps) {
+    if (node == NULL) return 0;
+    uint64_t node_off = writer.Append(node, sizeof(AbstNode));
+    uint64_t table_off = node->table ? save_hash_table(writer, node->table, bmps) : 0;
+    uint64_t left_off = save_abst_node(writer, node->left, bmps);
+    uint64_t right_off = save_abst_node(writer, node->right, bmps);
+    writer.SetPointer(node_off + offsetof(AbstNode, table), table_off);
+    writer.SetPointer(node_off + offsetof(AbstNode, left), left_off);
+    writer.SetPointer(node_off + offsetof(AbstNode, right), right_off);
+    return node_off;
+}
+
+bool save_abst(AbstNode* root, const string &path, const string &method) {
+    if (root == NULL) {
+        cout << method << "::Save() : tree is empty!!!" << endl;
+        return false;
+    }
+    SnapshotWriter writer;
+    unordered_map<const Entry*, uint64_t> bmps;
+    writer.params[0] = save_abst_node(writer, root, bmps);
+    return writer.Write(path, method);
+}
+
+AbstNode* load_abst(SnapshotImage* &snapshot, const string &path, const string &method) {
+    SnapshotImage* image = new SnapshotImage;
+    if (!image->Open(path, method) || !image->CheckParam(0, 1, sizeof(AbstNode))) {
+        delete image;
+        return NULL;
+    }
+    delete snapshot;
+    snapshot = image;
+    return image->At<AbstNode>(image->Param(0));
+}
+
+void ABST::LookupBatch(const Trace *traces, size_t n, uint32_t *out){
+    abst_lookup_batch(root, traces, n, out);
+}
+
 uint64_t ABST::CalMemory(){
     uint64_t total = 0;
     total += sizeof(AbstNode *);
@@ -265,7 +377,21 @@ uint64_t ABST::CalMemory(){
     return total;
 }
 
-ABST::~ABST(){}
+bool ABST::Save(const string &path){
+    return save_abst(root, path, "ABST");
+}
+
+bool ABST::Load(const string &path){
+    AbstNode* tree = load_abst(snapshot, path, "ABST");
+    if (tree == NULL) return false;
+    root = tree;
+    aux = NULL;
+    return true;
+}
+
+ABST::~ABST(){
+    delete snapshot;
+}
 
 /***************************************
 *               ABST_TD                *
@@ -273,6 +399,7 @@ ABST::~ABST(){}
 ABST_TD::ABST_TD(){
     root = NULL;
     aux = NULL;
+    snapshot = NULL;
 }
 
 void ABST_TD::Create(vector<Prefix*> &prefixs, ProgramState *ps){
@@ -424,6 +551,10 @@ uint32_t ABST_TD::Lookup(Trace *trace){
     return result;
 }
 
+void ABST_TD::LookupBatch(const Trace *traces, size_t n, uint32_t *out){
+    abst_lookup_batch(root, traces, n, out);
+}
+
 uint64_t ABST_TD::CalMemory(){
     uint64_t total = 0;
     total += sizeof(AbstNode *);
@@ -431,4 +562,18 @@ uint64_t ABST_TD::CalMemory(){
     return total;
 }
 
-ABST_TD::~ABST_TD(){}
\ No newline at end of file
+bool ABST_TD::Save(const string &path){
+    return save_abst(root, path, "ABST_TD");
+}
+
+bool ABST_TD::Load(const string &path){
+    AbstNode* tree = load_abst(snapshot, path, "ABST_TD");
+    if (tree == NULL) return false;
+    root = tree;
+    aux = NULL;
+    return true;
+}
+
+ABST_TD::~ABST_TD(){
+    delete snapshot;
+}
\ No newline at end of file
@@ -27,12 +27,16 @@ public:
     void Create(vector<Prefix*> &prefixs, ProgramState *ps);   
     uint32_t Lookup(Trace *trace, ProgramState *ps);
     uint32_t Lookup(Trace *trace);       
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out);
     uint64_t CalMemory();                              
+    bool Save(const string &path);
+    bool Load(const string &path);
     ~ABST();
 
 private:
     AbstNode *root;
     AbstTrieNode *aux;
+    SnapshotImage *snapshot;
 };
 
 class ABST_TD : public Classifier {
@@ -41,11 +45,15 @@ public:
     void Create(vector<Prefix*> &prefixs, ProgramState *ps);   
     uint32_t Lookup(Trace *trace, ProgramState *ps);
     uint32_t Lookup(Trace *trace);       
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out);
     uint64_t CalMemory();                              
+    bool Save(const string &path);
+    bool Load(const string &path);
     ~ABST_TD();
 
 private:
     AbstNode *root;
     AbstTrieNode *aux;
+    SnapshotImage *snapshot;
 };
 #endif
\ No newline at end of file
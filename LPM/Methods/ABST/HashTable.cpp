@@ -28,102 +28,142 @@ clib_xxhash (uint64_t key)
     return h64;
 }
 
-const uint64_t mask = (~((uint64_t)0)) >> (64 - 16);
+static inline uint64_t Abst_hash(__uint128_t prefix) {
+    return clib_xxhash((uint64_t)((prefix >> 64) ^ prefix));
+}
 
-static int Abst_hash(__uint128_t prefix, int size) {
-    uint64_t hash = clib_xxhash((uint64_t)((prefix >> 64) ^ prefix));
-    return (int)(hash & mask);
+static inline uint8_t Abst_hash_tag(uint64_t hash) {
+    return (uint8_t)(hash & 0x7F);
 }
 
+static inline size_t Abst_hash_group(uint64_t hash, size_t group_mask) {
+    return (size_t)(hash >> 7) & group_mask;
+}
 
+static void HashTable_alloc(HashTable* table, int bucket_size) {
+    void* ctrl = NULL;
+    if (posix_memalign(&ctrl, 64, bucket_size) != 0) {
+        cout << "HashTable_alloc() : out of memory !!!" << endl;
+        exit(1);
+    }
+    table->ctrl = (uint8_t*)ctrl;
+    memset(table->ctrl, HASH_CTRL_EMPTY, bucket_size);
+    table->slots = (Entry*)malloc(bucket_size * sizeof(Entry));
+    table->bucket_size = bucket_size;
+}
+
+static Entry* HashTable_find_empty(HashTable* table, uint64_t hash) {
+    const size_t group_mask = table->bucket_size / HASH_TABLE_GROUP_WIDTH - 1;
+    const __m128i empty = _mm_set1_epi8((char)HASH_CTRL_EMPTY);
+    size_t group = Abst_hash_group(hash, group_mask);
+
+    for (size_t step = 1; ; ++step) {
+        uint8_t* ctrl = table->ctrl + group * HASH_TABLE_GROUP_WIDTH;
+        __m128i meta = _mm_load_si128((const __m128i*)ctrl);
+        uint32_t empty_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty));
+        if (empty_mask) {
+            int slot = __builtin_ctz(empty_mask);
+            ctrl[slot] = Abst_hash_tag(hash);
+            return &table->slots[group * HASH_TABLE_GROUP_WIDTH + slot];
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+static void HashTable_grow(HashTable* table) {
+    uint8_t* old_ctrl = table->ctrl;
+    Entry* old_slots = table->slots;
+    int old_size = table->bucket_size;
+
+    HashTable_alloc(table, old_size * 2);
+    for (int i = 0; i < old_size; i++) {
+        if (old_ctrl[i] == HASH_CTRL_EMPTY) continue;
+        *HashTable_find_empty(table, Abst_hash(old_slots[i].prefix)) = old_slots[i];
+    }
+    free(old_ctrl);
+    free(old_slots);
+}
 
 HashTable* HashTable_create() {
     HashTable* table = (HashTable*)malloc(sizeof(HashTable));
-    table->bucket_size = HASH_TABLE_INITIAL_SIZE;
     table->count = 0;
-    table->buckets = (HashNode**)calloc(table->bucket_size, sizeof(HashNode*));
+    HashTable_alloc(table, HASH_TABLE_INITIAL_SIZE);
     return table;
 }
 
 void HashTable_destroy(HashTable* table) {
-    for (int i = 0; i < table->bucket_size; i++) {
-        HashNode* current = table->buckets[i];
-        while (current) {
-            HashNode* temp = current;
-            current = current->next;
-            free(temp);
-        }
-    }
-    free(table->buckets);
+    free(table->ctrl);
+    free(table->slots);
     free(table);
 }
 
 void HashTable_insert(HashTable* table, Entry entry) {
-    int index = Abst_hash(entry.prefix, table->bucket_size);
-    // if(entry.prefix_len == 0)
-    //     printf("HashTable_insert: %016llx%016llx\n",
-    //         (unsigned long long)(entry.prefix >> 64), 
-    //         (unsigned long long)(entry.prefix & 0xFFFFFFFFFFFFFFFF));
-    // if(entry.prefix_len == 0)
-    //     printf("index:%d\n",index);
-
-    HashNode* current = table->buckets[index];
-    while (current) {
-        if (current->entry.prefix == entry.prefix) {
-            current->entry.label |= entry.label;
-            if(entry.label == PREFIX){
-                current->entry.port = entry.port;
-            } 
-            // if(entry.prefix_len == 0)
-            //     printf("current->entry.port:%d\n",current->entry.port);
-            return;
-        }
-        current = current->next;
+    Entry* current = HashTable_lookup(table, entry.prefix);
+    if (current) {
+        current->label |= entry.label;
+        if(entry.label == PREFIX){
+            current->port = entry.port;
+        } 
+        return;
     }
-    
-    HashNode* newNode = (HashNode*)malloc(sizeof(HashNode));
-    newNode->entry = entry;
-    newNode->next = table->buckets[index];
-    table->buckets[index] = newNode;
+
+    // 负载因子不超过 7/8, 保证探测时总能遇到空槽位
+    if ((table->count + 1) * 8 > table->bucket_size * 7) {
+        HashTable_grow(table);
+    }
+    *HashTable_find_empty(table, Abst_hash(entry.prefix)) = entry;
     table->count++;
-    // if(entry.prefix_len == 0)
-    //     printf("current->entry.port:%d\n",current->entry.port);
 }
 
 Entry* HashTable_lookup(HashTable* table, __uint128_t prefix, ProgramState *ps) {
-    int index = Abst_hash(prefix, table->bucket_size);
-    
-    // printf("Looking up prefix: %016llx%016llx\n",
-    //     (unsigned long long)(prefix >> 64), 
-    //     (unsigned long long)(prefix & 0xFFFFFFFFFFFFFFFF));
-    
-    HashNode* current = table->buckets[index];
-    while (current) {
-        // printf("  Compare with stored: %016llx%016llx\n",
-        //         (unsigned long long)(current->entry.prefix >> 64),
-        //         (unsigned long long)(current->entry.prefix & 0xFFFFFFFFFFFFFFFF)
-        //         );
+    const uint64_t hash = Abst_hash(prefix);
+    const size_t group_mask = table->bucket_size / HASH_TABLE_GROUP_WIDTH - 1;
+    const __m128i tag = _mm_set1_epi8((char)Abst_hash_tag(hash));
+    const __m128i empty = _mm_set1_epi8((char)HASH_CTRL_EMPTY);
+    size_t group = Abst_hash_group(hash, group_mask);
+
+    for (size_t step = 1; ; ++step) {
         ps->lookup_access.Addcount();
-        ps->lookup_access_entry.Addcount();
-        if (current->entry.prefix == prefix) {
-            return &current->entry;
+        __m128i meta = _mm_load_si128((const __m128i*)(table->ctrl + group * HASH_TABLE_GROUP_WIDTH));
+        uint32_t match = _mm_movemask_epi8(_mm_cmpeq_epi8(meta, tag));
+        while (match) {
+            Entry* current = &table->slots[group * HASH_TABLE_GROUP_WIDTH + __builtin_ctz(match)];
+            ps->lookup_access.Addcount();
+            ps->lookup_access_entry.Addcount();
+            if (current->prefix == prefix) {
+                return current;
+            }
+            match &= match - 1;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty))) {
+            return NULL;
         }
-        current = current->next;
+        group = (group + step) & group_mask;
     }
-    return NULL;
 }
 
 Entry* HashTable_lookup(HashTable* table, __uint128_t prefix) {
-    int index = Abst_hash(prefix, table->bucket_size);
-    
-    HashNode* current = table->buckets[index];
-    while (current) {
-        if (current->entry.prefix == prefix) {
-            return &current->entry;
+    const uint64_t hash = Abst_hash(prefix);
+    const size_t group_mask = table->bucket_size / HASH_TABLE_GROUP_WIDTH - 1;
+    const __m128i tag = _mm_set1_epi8((char)Abst_hash_tag(hash));
+    const __m128i empty = _mm_set1_epi8((char)HASH_CTRL_EMPTY);
+    size_t group = Abst_hash_group(hash, group_mask);
+
+    for (size_t step = 1; ; ++step) {
+        __m128i meta = _mm_load_si128((const __m128i*)(table->ctrl + group * HASH_TABLE_GROUP_WIDTH));
+        uint32_t match = _mm_movemask_epi8(_mm_cmpeq_epi8(meta, tag));
+        while (match) {
+            Entry* current = &table->slots[group * HASH_TABLE_GROUP_WIDTH + __builtin_ctz(match)];
+            if (current->prefix == prefix) {
+                return current;
+            }
+            match &= match - 1;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(meta, empty))) {
+            return NULL;
         }
-        current = current->next;
+        group = (group + step) & group_mask;
     }
-    return NULL;
 }
 
 size_t HashTable_cal_memory(HashTable* table) {
@@ -133,8 +173,8 @@ size_t HashTable_cal_memory(HashTable* table) {
     
     size_t total = 0;
     total += sizeof(HashTable);
-    total += table->bucket_size * sizeof(HashNode*);
-    total += table->count * sizeof(HashNode);
+    total += table->bucket_size * sizeof(uint8_t);
+    total += table->bucket_size * sizeof(Entry);
     
     return total;
 }
\ No newline at end of file
@@ -1,11 +1,14 @@
 #ifndef ABST_HASHTABLE_H
 #define ABST_HASHTABLE_H
 
-#define HASH_TABLE_INITIAL_SIZE 65536
+#define HASH_TABLE_INITIAL_SIZE 16
+#define HASH_TABLE_GROUP_WIDTH 16
+#define HASH_CTRL_EMPTY 0x80
 #define PREFIX 0x01
 #define MARKER 0x02
 
 #include "../../Elements/Elements.h"
+#include <emmintrin.h>
 
 typedef struct Entry {
     uint8_t label;
@@ -15,13 +18,10 @@ typedef struct Entry {
     struct Entry* bmp;
 }Entry;
 
-typedef struct HashNode {
-    Entry entry;
-    struct HashNode* next;  
-} HashNode;  
-
+// 开放寻址表: ctrl 每个槽位一字节 (HASH_CTRL_EMPTY 或哈希低 7 位), 按 16 个槽位一组用 SSE2 比较
 typedef struct HashTable{
-    HashNode** buckets;   
+    uint8_t* ctrl;
+    Entry* slots;
     int bucket_size;         
     int count;         
 } HashTable;
@@ -6,12 +6,22 @@
 
 using namespace std;
 
+#define LOOKUP_BATCH_WIDTH 16
+
 class Classifier {
 public:
+    virtual ~Classifier() {}
     virtual void Create(vector<Prefix*> &prefixs, ProgramState *ps) = 0; 
     virtual uint32_t Lookup(Trace *trace, ProgramState *ps) = 0;         
     virtual uint32_t Lookup(Trace *trace) = 0;                          
+    virtual void LookupBatch(const Trace *traces, size_t n, uint32_t *out) = 0;
+    // AMAC 预取批量查找, width 个报文同时在途; 未实现的方法返回 false
+    virtual bool LookupBatchPrefetch(const Trace *traces, size_t n, uint32_t *out, uint32_t width) { return false; }
     virtual uint64_t CalMemory() = 0;                                   
+    virtual bool Insert(Prefix *prefix) { return false; }               
+    virtual bool Delete(Prefix *prefix) { return false; }               
+    virtual bool Save(const string &path) { return false; }             
+    virtual bool Load(const string &path) { return false; }             
 };
 
 #endif
\ No newline at end of file
@@ -238,12 +238,145 @@ uint64_t _CalMemory(DirTable* table) {
     return total_mem;
 }
 
+// 快照: DirTable 与其表项数组依次写入镜像, entries / subtable 指针登记为重定位字段
+uint64_t save_dir_table(SnapshotWriter &writer, const DirTable* table) {
+    uint64_t table_off = writer.Append(table, sizeof(DirTable));
+    uint64_t entries_off = writer.Append(table->entries, (size_t)table->entry_count * sizeof(TableEntry));
+    writer.SetPointer(table_off + offsetof(DirTable, entries), entries_off);
+
+    for (uint32_t i = 0; i < table->entry_count; ++i) {
+        const DirTable* subtable = table->entries[i].subtable;
+        if (subtable == NULL) continue;
+        uint64_t sub_off = save_dir_table(writer, subtable);
+        writer.SetPointer(entries_off + (uint64_t)i * sizeof(TableEntry) + offsetof(TableEntry, subtable), sub_off);
+    }
+    return table_off;
+}
+
+bool save_dir248(DirTable* root, const string &path, const string &method) {
+    if (root == NULL) {
+        cout << method << "::Save() : table is empty !!!" << endl;
+        return false;
+    }
+    SnapshotWriter writer;
+    writer.params[0] = save_dir_table(writer, root);
+    return writer.Write(path, method);
+}
+
+DirTable* load_dir248(SnapshotImage* &snapshot, const string &path, const string &method) {
+    SnapshotImage* image = new SnapshotImage;
+    if (!image->Open(path, method) || !image->CheckParam(0, 1, sizeof(DirTable))) {
+        delete image;
+        return NULL;
+    }
+    delete snapshot;
+    snapshot = image;
+    return image->At<DirTable>(image->Param(0));
+}
+
+// 批量查找: 同一批报文按层同步推进, 各报文的访存互不依赖, 可以并行发出
+void dir248_lookup_batch(DirTable* root, const Trace* traces, size_t n, uint32_t* out) {
+    __uint128_t ip[LOOKUP_BATCH_WIDTH];
+    const DirTable* table[LOOKUP_BATCH_WIDTH];
+    int shift[LOOKUP_BATCH_WIDTH];
+    uint32_t best_match[LOOKUP_BATCH_WIDTH];
+
+    for (size_t base = 0; base < n; base += LOOKUP_BATCH_WIDTH) {
+        const size_t cnt = min((size_t)LOOKUP_BATCH_WIDTH, n - base);
+        for (size_t i = 0; i < cnt; ++i) {
+            ip[i] = ((__uint128_t)traces[base + i].ip6_upper << 64) | traces[base + i].ip6_lower;
+            table[i] = root;
+            shift[i] = 128;
+            best_match[i] = 0;
+        }
+
+        size_t active = root ? cnt : 0;
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                if (!table[i]) continue;
+                shift[i] -= table[i]->stride;
+                const uint32_t idx = (ip[i] >> shift[i]) & table[i]->mask;
+                const TableEntry& entry = table[i]->entries[idx];
+
+                best_match[i] = entry.is_valid ? entry.next_hop : best_match[i];
+                table[i] = entry.subtable;
+                if (table[i]) active++;
+            }
+        }
+
+        for (size_t i = 0; i < cnt; ++i) {
+            out[base + i] = best_match[i];
+        }
+    }
+}
+
+static inline void dir248_prefetch_start(DirLookupState& state, DirTable* root, const Trace& trace, size_t idx) {
+    state.ip = ((__uint128_t)trace.ip6_upper << 64) | trace.ip6_lower;
+    state.idx = idx;
+    state.best_match = 0;
+    state.table = root;
+    state.shift = 128 - root->stride;
+    state.entry = &root->entries[(state.ip >> state.shift) & root->mask];
+    __builtin_prefetch(state.entry, 0, 3);
+}
+
+// AMAC 查找: width 个报文同时在途, 每次访存前先预取, 轮到该报文时数据已在缓存中
+// 每层分两步: 取 DirTable 表头得到 entry 地址并预取, 再读 entry 得到下一级表并预取
+void dir248_lookup_prefetch(DirTable* root, const Trace* traces, size_t n, uint32_t* out, uint32_t width) {
+    if (root == NULL) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+        return;
+    }
+
+    DirLookupState state[DIR248_MAX_PREFETCH_WIDTH];
+    width = min(width, (uint32_t)DIR248_MAX_PREFETCH_WIDTH);
+
+    size_t next = 0, done = 0;
+    uint32_t inflight = 0;
+    while (inflight < width && next < n) {
+        dir248_prefetch_start(state[inflight++], root, traces[next], next);
+        next++;
+    }
+
+    while (done < n) {
+        for (uint32_t s = 0; s < inflight; ++s) {
+            DirLookupState& st = state[s];
+            if (st.table == NULL) continue;
+
+            if (st.entry == NULL) {
+                st.shift -= st.table->stride;
+                st.entry = &st.table->entries[(st.ip >> st.shift) & st.table->mask];
+                __builtin_prefetch(st.entry, 0, 3);
+                continue;
+            }
+
+            const TableEntry& entry = *st.entry;
+            st.best_match = entry.is_valid ? entry.next_hop : st.best_match;
+            st.table = entry.subtable;
+            st.entry = NULL;
+            if (st.table) {
+                __builtin_prefetch(st.table, 0, 3);
+                continue;
+            }
+
+            out[st.idx] = st.best_match;
+            done++;
+            if (next < n) {
+                dir248_prefetch_start(st, root, traces[next], next);
+                next++;
+            }
+        }
+    }
+}
+
 /***************************************
 *                DIR248                *
 ***************************************/
 
 DIR248::DIR248(){
     root = NULL;
+    snapshot = NULL;
 }
 
 void DIR248::Create(vector<Prefix*> &prefixs, ProgramState *ps){
@@ -308,17 +441,40 @@ uint32_t DIR248::Lookup(Trace *trace){
     return best_match;
 }
 
+void DIR248::LookupBatch(const Trace *traces, size_t n, uint32_t *out){
+    dir248_lookup_batch(root, traces, n, out);
+}
+
+bool DIR248::LookupBatchPrefetch(const Trace *traces, size_t n, uint32_t *out, uint32_t width){
+    dir248_lookup_prefetch(root, traces, n, out, width);
+    return true;
+}
+
 uint64_t DIR248::CalMemory(){
     return _CalMemory(root);
 }
 
-DIR248::~DIR248(){}
+bool DIR248::Save(const string &path){
+    return save_dir248(root, path, "DIR248");
+}
+
+bool DIR248::Load(const string &path){
+    DirTable* table = load_dir248(snapshot, path, "DIR248");
+    if (table == NULL) return false;
+    root = table;
+    return true;
+}
+
+DIR248::~DIR248(){
+    delete snapshot;
+}
 
 /***************************************
 *                DIR248_TD             *
 ***************************************/
 DIR248_TD::DIR248_TD(){
     root = NULL;
+    snapshot = NULL;
 }
 
 void DIR248_TD::Create(vector<Prefix*> &prefixs, ProgramState *ps){ 
@@ -383,8 +539,219 @@ uint32_t DIR248_TD::Lookup(Trace *trace){
     return best_match;
 }
 
+void DIR248_TD::LookupBatch(const Trace *traces, size_t n, uint32_t *out){
+    dir248_lookup_batch(root, traces, n, out);
+}
+
+bool DIR248_TD::LookupBatchPrefetch(const Trace *traces, size_t n, uint32_t *out, uint32_t width){
+    dir248_lookup_prefetch(root, traces, n, out, width);
+    return true;
+}
+
 uint64_t DIR248_TD::CalMemory(){
     return _CalMemory(root);
 }
 
-DIR248_TD::~DIR248_TD(){}
\ No newline at end of file
+bool DIR248_TD::Save(const string &path){
+    return save_dir248(root, path, "DIR248_TD");
+}
+
+bool DIR248_TD::Load(const string &path){
+    DirTable* table = load_dir248(snapshot, path, "DIR248_TD");
+    if (table == NULL) return false;
+    root = table;
+    return true;
+}
+
+DIR248_TD::~DIR248_TD(){
+    delete snapshot;
+}
+
+/***************************************
+*             DIR248_Compact           *
+***************************************/
+void build_dir248_compact(vector<uint32_t>& words, size_t base, uint8_t stride, vector<Prefix*>& prefixs, 
+                          uint8_t current_len, vector<uint32_t>& pool) {
+    const uint32_t entry_count = 1U << stride;
+    const uint32_t stride_mask = entry_count - 1;
+    const uint8_t total_bits = current_len + stride;
+
+    vector<uint8_t> is_valid(entry_count, 0);
+    map<uint32_t, vector<Prefix*>> next_level;
+
+    for (auto prefix : prefixs) {
+        __uint128_t ip = trim_prefix( 
+            ((__uint128_t)((__uint128_t)prefix->ip6_upper << 64) | (__uint128_t)prefix->ip6_lower), 
+            prefix->prefix_len);
+        const uint32_t idx = (ip >> (128 - total_bits)) & stride_mask;
+
+        if (prefix->prefix_len <= total_bits) {
+            const uint32_t coverage = 1U << (total_bits - prefix->prefix_len);
+            for (uint32_t j = 0; j < coverage; ++j) {
+                if (is_valid[idx | j]) continue;
+                is_valid[idx | j] = 1;
+                words[base + (idx | j)] = prefix->port;
+            }
+        } else {
+            next_level[idx].push_back(prefix);
+        }
+    }
+
+    for (auto& it : next_level) {
+        size_t sub_base = pool.size();
+        pool.resize(sub_base + (1U << DIR248_COMPACT_STRIDE), words[base + it.first]);
+        build_dir248_compact(pool, sub_base, DIR248_COMPACT_STRIDE, it.second, total_bits, pool);
+        words[base + it.first] = DIR248_COMPACT_SUBTABLE | (uint32_t)(sub_base >> DIR248_COMPACT_STRIDE);
+    }
+}
+
+DIR248_Compact::DIR248_Compact(){
+    root = NULL;
+    pool = NULL;
+    subtable_count = 0;
+    snapshot = NULL;
+}
+
+void DIR248_Compact::Create(vector<Prefix*> &prefixs, ProgramState *ps){
+    int prefixs_num = prefixs.size();
+    if(prefixs_num == 0){
+        cout << "DIR248_Compact::Create() : prefixs is empty !!!" << endl;
+        return;
+    }
+
+    sort(prefixs.begin(), prefixs.end(), cmp_for_dir248);
+
+    vector<uint32_t> root_words(1U << DIR248_COMPACT_ROOT_STRIDE, 0);
+    vector<uint32_t> pool_words;
+    build_dir248_compact(root_words, 0, DIR248_COMPACT_ROOT_STRIDE, prefixs, 0, pool_words);
+
+    subtable_count = pool_words.size() >> DIR248_COMPACT_STRIDE;
+    root = (uint32_t*)linux_aligned_malloc_64(root_words.size() * sizeof(uint32_t));
+    memcpy(root, root_words.data(), root_words.size() * sizeof(uint32_t));
+    if (subtable_count > 0) {
+        pool = (uint32_t*)linux_aligned_malloc_64(pool_words.size() * sizeof(uint32_t));
+        memcpy(pool, pool_words.data(), pool_words.size() * sizeof(uint32_t));
+    }
+}
+
+uint32_t DIR248_Compact::Lookup(Trace *trace, ProgramState *ps){
+    // 前缀表为空时 Create 不分配 root, 与 DIR248 一致返回 0
+    if (root == NULL) {
+        ps->lookup_access.Cal();
+        ps->lookup_depth.Cal();
+        return 0;
+    }
+    __uint128_t ip = ((__uint128_t)trace->ip6_upper << 64) | trace->ip6_lower;
+    int shift = 128 - DIR248_COMPACT_ROOT_STRIDE;
+
+    ps->lookup_access.Addcount();
+    ps->lookup_depth.Addcount();
+    uint32_t word = root[(uint32_t)(ip >> shift)];
+
+    while (word & DIR248_COMPACT_SUBTABLE) {
+        ps->lookup_access.Addcount();
+        ps->lookup_depth.Addcount();
+        shift -= DIR248_COMPACT_STRIDE;
+        const size_t idx = ((size_t)(word & ~DIR248_COMPACT_SUBTABLE) << DIR248_COMPACT_STRIDE) | ((ip >> shift) & DIR248_COMPACT_MASK);
+        word = pool[idx];
+    }
+
+    ps->lookup_access.Cal();
+    ps->lookup_depth.Cal();
+    return word;
+}
+
+uint32_t DIR248_Compact::Lookup(Trace *trace){
+    if (root == NULL) return 0;
+    __uint128_t ip = ((__uint128_t)trace->ip6_upper << 64) | trace->ip6_lower;
+    int shift = 128 - DIR248_COMPACT_ROOT_STRIDE;
+    uint32_t word = root[(uint32_t)(ip >> shift)];
+
+    while (word & DIR248_COMPACT_SUBTABLE) {
+        shift -= DIR248_COMPACT_STRIDE;
+        const size_t idx = ((size_t)(word & ~DIR248_COMPACT_SUBTABLE) << DIR248_COMPACT_STRIDE) | ((ip >> shift) & DIR248_COMPACT_MASK);
+        word = pool[idx];
+    }
+    return word;
+}
+
+void DIR248_Compact::LookupBatch(const Trace *traces, size_t n, uint32_t *out){
+    if (root == NULL) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+        return;
+    }
+    __uint128_t ip[LOOKUP_BATCH_WIDTH];
+    int shift[LOOKUP_BATCH_WIDTH];
+
+    for (size_t base = 0; base < n; base += LOOKUP_BATCH_WIDTH) {
+        const size_t cnt = min((size_t)LOOKUP_BATCH_WIDTH, n - base);
+        size_t active = 0;
+        for (size_t i = 0; i < cnt; ++i) {
+            ip[i] = ((__uint128_t)traces[base + i].ip6_upper << 64) | traces[base + i].ip6_lower;
+            shift[i] = 128 - DIR248_COMPACT_ROOT_STRIDE;
+            out[base + i] = root[(uint32_t)(ip[i] >> shift[i])];
+            if (out[base + i] & DIR248_COMPACT_SUBTABLE) active++;
+        }
+
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                uint32_t word = out[base + i];
+                if (!(word & DIR248_COMPACT_SUBTABLE)) continue;
+                shift[i] -= DIR248_COMPACT_STRIDE;
+                word = pool[((size_t)(word & ~DIR248_COMPACT_SUBTABLE) << DIR248_COMPACT_STRIDE) | ((ip[i] >> shift[i]) & DIR248_COMPACT_MASK)];
+                out[base + i] = word;
+                if (word & DIR248_COMPACT_SUBTABLE) active++;
+            }
+        }
+    }
+}
+
+uint64_t DIR248_Compact::CalMemory(){
+    uint64_t total_mem = 0;
+    total_mem += (uint64_t)(1U << DIR248_COMPACT_ROOT_STRIDE) * sizeof(uint32_t);
+    total_mem += (uint64_t)subtable_count * (1U << DIR248_COMPACT_STRIDE) * sizeof(uint32_t);
+    return total_mem;
+}
+
+// 紧凑表只由下标组成, 镜像无需重定位, Load 后 root / pool 直接指向共享的只读映射
+bool DIR248_Compact::Save(const string &path){
+    if (root == NULL) {
+        cout << "DIR248_Compact::Save() : table is empty !!!" << endl;
+        return false;
+    }
+    SnapshotWriter writer;
+    writer.params[0] = subtable_count;
+    writer.params[1] = writer.Append(root, (size_t)(1U << DIR248_COMPACT_ROOT_STRIDE) * sizeof(uint32_t));
+    writer.params[2] = writer.Append(pool, (size_t)subtable_count * (1U << DIR248_COMPACT_STRIDE) * sizeof(uint32_t));
+    return writer.Write(path, "DIR248_Compact");
+}
+
+bool DIR248_Compact::Load(const string &path){
+    SnapshotImage* image = new SnapshotImage;
+    if (!image->Open(path, "DIR248_Compact") ||
+        !image->CheckParam(1, 1U << DIR248_COMPACT_ROOT_STRIDE, sizeof(uint32_t)) ||
+        (image->Param(0) > 0 && !image->CheckParam(2, image->Param(0), sizeof(uint32_t) << DIR248_COMPACT_STRIDE))) {
+        delete image;
+        return false;
+    }
+    if (snapshot == NULL) {
+        if (root) linux_aligned_free_64(root);
+        if (pool) linux_aligned_free_64(pool);
+    }
+    delete snapshot;
+    snapshot = image;
+    subtable_count = image->Param(0);
+    root = image->At<uint32_t>(image->Param(1));
+    pool = subtable_count > 0 ? image->At<uint32_t>(image->Param(2)) : NULL;
+    return true;
+}
+
+DIR248_Compact::~DIR248_Compact(){
+    if (snapshot) {
+        delete snapshot;
+        return;
+    }
+    if (root) linux_aligned_free_64(root);
+    if (pool) linux_aligned_free_64(pool);
+}
\ No newline at end of file
@@ -23,17 +23,33 @@ typedef struct DirTable {
     uint8_t  padding[15];   
 } __attribute__((aligned(64))) DirTable; 
 
+#define DIR248_MAX_PREFETCH_WIDTH 64
+
+typedef struct DirLookupState {
+    __uint128_t ip;
+    const DirTable* table;      
+    const TableEntry* entry;    
+    size_t idx;                 
+    uint32_t best_match;
+    int shift;
+} DirLookupState;
+
 class DIR248 : public Classifier {
 public:
     DIR248();
     void Create(vector<Prefix*> &prefixs, ProgramState *ps);   
     uint32_t Lookup(Trace *trace, ProgramState *ps);
     uint32_t Lookup(Trace *trace);       
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out);
+    bool LookupBatchPrefetch(const Trace *traces, size_t n, uint32_t *out, uint32_t width);
     uint64_t CalMemory();                              
+    bool Save(const string &path);
+    bool Load(const string &path);
     ~DIR248();
 
 private:
     DirTable* root;            
+    SnapshotImage* snapshot;   
 };
 
 class DIR248_TD : public Classifier {
@@ -42,10 +58,40 @@ public:
     void Create(vector<Prefix*> &prefixs, ProgramState *ps);   
     uint32_t Lookup(Trace *trace, ProgramState *ps);
     uint32_t Lookup(Trace *trace);       
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out);
+    bool LookupBatchPrefetch(const Trace *traces, size_t n, uint32_t *out, uint32_t width);
     uint64_t CalMemory();                              
+    bool Save(const string &path);
+    bool Load(const string &path);
     ~DIR248_TD();
 
 private:
     DirTable* root;           
+    SnapshotImage* snapshot;  
+};
+
+// 紧凑表项: 32 位字, 最高位为 1 时低 31 位是子表在 pool 中的下标, 否则为下一跳 (前缀下推到子表)
+#define DIR248_COMPACT_SUBTABLE   (1U << 31)
+#define DIR248_COMPACT_ROOT_STRIDE 24
+#define DIR248_COMPACT_STRIDE      8
+#define DIR248_COMPACT_MASK        ((1U << DIR248_COMPACT_STRIDE) - 1)
+
+class DIR248_Compact : public Classifier {
+public:
+    DIR248_Compact();
+    void Create(vector<Prefix*> &prefixs, ProgramState *ps);   
+    uint32_t Lookup(Trace *trace, ProgramState *ps);
+    uint32_t Lookup(Trace *trace);       
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out);
+    uint64_t CalMemory();                              
+    bool Save(const string &path);
+    bool Load(const string &path);
+    ~DIR248_Compact();
+
+private:
+    uint32_t* root;            
+    uint32_t* pool;            
+    uint32_t subtable_count;   
+    SnapshotImage* snapshot;   // Load 之后 root / pool 指向只读映射
 };
 #endif
\ No newline at end of file
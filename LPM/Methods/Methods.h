@@ -5,5 +5,7 @@
 #include "DIR248/DIR248.h"
 #include "Poptrie/Poptrie.h"
 #include "Poptrie_TD/Poptrie_TD.h"
+#include "RCU/RcuClassifier.h"
+#include "RCU/TDOptimizer.h"
 
 #endif
\ No newline at end of file
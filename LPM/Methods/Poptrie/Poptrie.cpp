@@ -5,10 +5,9 @@
 
 const uint8_t Poptrie::TOP_LEVEL_STRIDE = 16;
 
-Poptrie::Poptrie() : totalMemory(0) {
+Poptrie::Poptrie() : nodes(nullptr), nodesSize(0), nodesCapacity(0),
+                     leaves(nullptr), leavesSize(0), leavesCapacity(0), snapshot(nullptr) {
     topLevel.indexTable = nullptr;    
-    topLevel.directResult = nullptr;  
-    topLevel.internalNodes = nullptr; 
 }
 
 Poptrie::~Poptrie() {
@@ -16,57 +15,66 @@ Poptrie::~Poptrie() {
 }
 
 void Poptrie::clear() {
-    if (topLevel.internalNodes != nullptr && topLevel.indexTable != nullptr) {
-        uint32_t topLevelSize = 1ULL << TOP_LEVEL_STRIDE; 
-        uint32_t internalNodeCount = 0;
-        
-        for (uint32_t i = 0; i < topLevelSize; ++i) {
-            if (!(topLevel.indexTable[i] & (1ULL << 31))) {
-                internalNodeCount++;
-            }
-        }
-
-        for (uint32_t i = 0; i < internalNodeCount; ++i) {
-            destroyInternalNode(&topLevel.internalNodes[i]);
-        }
-        
-        delete[] topLevel.internalNodes;
-        topLevel.internalNodes = nullptr;
+    if (snapshot != nullptr) {
+        delete snapshot;
+        snapshot = nullptr;
+        topLevel.indexTable = nullptr;
+        nodes = nullptr;
+        leaves = nullptr;
     }
-    
+
     if (topLevel.indexTable != nullptr) {
         delete[] topLevel.indexTable;
         topLevel.indexTable = nullptr;
     }
-    
-    if (topLevel.directResult != nullptr) {
-        delete[] topLevel.directResult;
-        topLevel.directResult = nullptr;
-    }
 
-    totalMemory = 0;
+    free(nodes);
+    nodes = nullptr;
+    nodesSize = nodesCapacity = 0;
+
+    free(leaves);
+    leaves = nullptr;
+    leavesSize = leavesCapacity = 0;
 }
 
-void Poptrie::destroyInternalNode(InternalNode* node) {
-    if (node == nullptr) return; 
-    
-    if (node->childNodes != nullptr) {
-        uint32_t childCount = 0;
-        for (int i = 0; i < 8; ++i) {
-            childCount += __builtin_popcountll(node->bitVector[i]);
+uint32_t Poptrie::allocNodes(uint32_t count) {
+    uint32_t base = nodesSize;
+    if (nodesSize + count > nodesCapacity) {
+        nodesCapacity = max(nodesSize + count, max(nodesCapacity * 2, 1024U));
+        nodes = static_cast<InternalNode*>(realloc(nodes, sizeof(InternalNode) * nodesCapacity));
+        if (nodes == nullptr) {
+            cout << "Poptrie::allocNodes() : out of memory" << endl;
+            exit(-1);
         }
-        
-        for (uint32_t i = 0; i < childCount; ++i) {
-            destroyInternalNode(&node->childNodes[i]);
+    }
+    memset(&nodes[base], 0, sizeof(InternalNode) * count);
+    nodesSize += count;
+    return base;
+}
+
+uint32_t Poptrie::allocLeaves(uint32_t count) {
+    uint32_t base = leavesSize;
+    if (leavesSize + count > leavesCapacity) {
+        leavesCapacity = max(leavesSize + count, max(leavesCapacity * 2, 4096U));
+        leaves = static_cast<uint32_t*>(realloc(leaves, sizeof(uint32_t) * leavesCapacity));
+        if (leaves == nullptr) {
+            cout << "Poptrie::allocLeaves() : out of memory" << endl;
+            exit(-1);
         }
-        
-        delete[] node->childNodes;
-        node->childNodes = nullptr;
     }
-    
-    if (node->directResult != nullptr) {
-        delete[] node->directResult;
-        node->directResult = nullptr;
+    memset(&leaves[base], 0, sizeof(uint32_t) * count);
+    leavesSize += count;
+    return base;
+}
+
+void Poptrie::shrinkArena() {
+    if (nodesSize > 0 && nodesSize < nodesCapacity) {
+        nodes = static_cast<InternalNode*>(realloc(nodes, sizeof(InternalNode) * nodesSize));
+        nodesCapacity = nodesSize;
+    }
+    if (leavesSize > 0 && leavesSize < leavesCapacity) {
+        leaves = static_cast<uint32_t*>(realloc(leaves, sizeof(uint32_t) * leavesSize));
+        leavesCapacity = leavesSize;
     }
 }
 
@@ -136,8 +144,10 @@ unordered_map<uint32_t, vector<Prefix*>> Poptrie::groupPrefixesByRange(
     return rangeToPrefixes;
 }
 
-void Poptrie::buildInternalNode(InternalNode* node, const vector<Prefix*>& prefixes, 
+void Poptrie::buildInternalNode(uint32_t nodeIndex, const vector<Prefix*>& prefixes, 
                                 uint8_t currentDepth) {
+    InternalNode tmp;
+    InternalNode* node = &tmp;
     node->stride = 6;
     if (currentDepth + node->stride > 128) {
         node->stride = 128 - currentDepth;
@@ -162,15 +172,10 @@ void Poptrie::buildInternalNode(InternalNode* node, const vector<Prefix*>& prefi
     }
     
     uint32_t directResultSize = totalRangeCount - childNodeCount; 
-    node->directResult = new uint32_t[directResultSize]();        
-    totalMemory += sizeof(uint32_t) * directResultSize;           
-    
-    node->childNodes = nullptr;
-    if (childNodeCount > 0) {
-        node->childNodes = new InternalNode[childNodeCount]();    
-        totalMemory += sizeof(InternalNode) * childNodeCount;     
-    }
-    
+    node->leafBase = allocLeaves(directResultSize);
+    node->nodeBase = childNodeCount > 0 ? allocNodes(childNodeCount) : 0;
+    nodes[nodeIndex] = tmp;
+
     uint32_t currentChildIdx = 0; 
     for (uint32_t range = 0; range < totalRangeCount; ++range) {
         auto it = rangeToPrefixes.find(range);
@@ -184,13 +189,13 @@ void Poptrie::buildInternalNode(InternalNode* node, const vector<Prefix*>& prefi
                 bestPort = rangePrefixes[0]->port;
             }
             if (directIndex < directResultSize) {
-                node->directResult[directIndex] = bestPort;
+                leaves[tmp.leafBase + directIndex] = bestPort;
             }
             continue;
         }
         
-        if (node->childNodes != nullptr && currentChildIdx < childNodeCount) {
-            buildInternalNode(&node->childNodes[currentChildIdx], rangePrefixes, currentDepth + stride);
+        if (currentChildIdx < childNodeCount) {
+            buildInternalNode(tmp.nodeBase + currentChildIdx, rangePrefixes, currentDepth + stride);
             currentChildIdx++;
         }
     }
@@ -209,19 +214,11 @@ void Poptrie::buildTopLevel(const vector<Prefix*>& prefixes) {
         }
     }
     
-    // 步骤4：分配顶层内存
     topLevel.indexTable = new uint32_t[topLevelSize]();  
-    totalMemory += sizeof(uint32_t) * topLevelSize;     
     
     uint32_t directResultSize = topLevelSize - internalNodeCount; 
-    topLevel.directResult = new uint32_t[directResultSize]();     
-    totalMemory += sizeof(uint32_t) * directResultSize;          
-    
-    topLevel.internalNodes = nullptr;
-    if (internalNodeCount > 0) {
-        topLevel.internalNodes = new InternalNode[internalNodeCount](); 
-        totalMemory += sizeof(InternalNode) * internalNodeCount;        
-    }
+    uint32_t directBase = allocLeaves(directResultSize);
+    uint32_t internalBase = internalNodeCount > 0 ? allocNodes(internalNodeCount) : 0;
 
     uint32_t currentInternalIdx = 0; 
     for (uint32_t range = 0; range < topLevelSize; ++range) {
@@ -235,16 +232,16 @@ void Poptrie::buildTopLevel(const vector<Prefix*>& prefixes) {
                 bestPort = rangePrefixes[0]->port;
             }
 
-            topLevel.indexTable[range] = directIndex | (1ULL << 31);
+            topLevel.indexTable[range] = (directBase + directIndex) | (1ULL << 31);
             if (directIndex < directResultSize) {
-                topLevel.directResult[directIndex] = bestPort;
+                leaves[directBase + directIndex] = bestPort;
             }
             continue;
         }
         
-        if (topLevel.internalNodes != nullptr && currentInternalIdx < internalNodeCount) {
-            topLevel.indexTable[range] = currentInternalIdx;
-            buildInternalNode(&topLevel.internalNodes[currentInternalIdx], rangePrefixes, TOP_LEVEL_STRIDE);
+        if (currentInternalIdx < internalNodeCount) {
+            topLevel.indexTable[range] = internalBase + currentInternalIdx;
+            buildInternalNode(internalBase + currentInternalIdx, rangePrefixes, TOP_LEVEL_STRIDE);
             currentInternalIdx++; 
         }
     }
@@ -264,6 +261,7 @@ void Poptrie::Create(vector<Prefix*> &prefixes, ProgramState *ps) {
         });
     
     buildTopLevel(prefixes);
+    shrinkArena();
 }
 
 uint32_t Poptrie::Lookup(Trace *trace, ProgramState *ps) {
@@ -279,10 +277,10 @@ uint32_t Poptrie::Lookup(Trace *trace, ProgramState *ps) {
     if (topIndex & (1ULL << 31)) {
         ps->lookup_access.Addcount(); 
         uint32_t directIndex = topIndex & ((1ULL << 31) - 1); 
-        resultPort = topLevel.directResult[directIndex];
+        resultPort = leaves[directIndex];
         ps->lookup_depth.Addcount(); 
     } else {
-        InternalNode* currentNode = &topLevel.internalNodes[topIndex]; 
+        const InternalNode* currentNode = &nodes[topIndex]; 
         uint8_t currentDepth = TOP_LEVEL_STRIDE; 
         ps->lookup_depth.Addcount();
         
@@ -293,12 +291,12 @@ uint32_t Poptrie::Lookup(Trace *trace, ProgramState *ps) {
                 ps->lookup_access.Addcount(); 
                 uint32_t childIndex = countSetBits(currentNode, range) - 1; 
                 currentDepth += currentNode->stride;                        
-                currentNode = &currentNode->childNodes[childIndex];         
+                currentNode = &nodes[currentNode->nodeBase + childIndex];         
                 ps->lookup_depth.Addcount();                                
             } else {
                 ps->lookup_access.Addcount(); 
                 uint32_t directIndex = range - countSetBits(currentNode, range);
-                resultPort = currentNode->directResult[directIndex];
+                resultPort = leaves[currentNode->leafBase + directIndex];
                 break;
             }
         }
@@ -319,9 +317,9 @@ uint32_t Poptrie::Lookup(Trace *trace) {
     
     if (topIndex & (1ULL << 31)) {
         uint32_t directIndex = topIndex & ((1ULL << 31) - 1);
-        return topLevel.directResult[directIndex];
+        return leaves[directIndex];
     } else {
-        InternalNode* currentNode = &topLevel.internalNodes[topIndex];
+        const InternalNode* currentNode = &nodes[topIndex];
         uint8_t currentDepth = TOP_LEVEL_STRIDE;
         
         while (true) {
@@ -330,15 +328,115 @@ uint32_t Poptrie::Lookup(Trace *trace) {
             if (isBitSet(currentNode, range)) {
                 uint32_t childIndex = countSetBits(currentNode, range) - 1;
                 currentDepth += currentNode->stride;
-                currentNode = &currentNode->childNodes[childIndex];
+                currentNode = &nodes[currentNode->nodeBase + childIndex];
             } else {
                 uint32_t directIndex = range - countSetBits(currentNode, range);
-                return currentNode->directResult[directIndex];
+                return leaves[currentNode->leafBase + directIndex];
+            }
+        }
+    }
+}
+
+void Poptrie::LookupBatch(const Trace *traces, size_t n, uint32_t *out) {
+    if (topLevel.indexTable == nullptr) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+        return;
+    }
+
+    __uint128_t ip[LOOKUP_BATCH_WIDTH];
+    const InternalNode* currentNode[LOOKUP_BATCH_WIDTH];
+    uint8_t currentDepth[LOOKUP_BATCH_WIDTH];
+
+    for (size_t base = 0; base < n; base += LOOKUP_BATCH_WIDTH) {
+        const size_t cnt = min((size_t)LOOKUP_BATCH_WIDTH, n - base);
+        size_t active = 0;
+
+        for (size_t i = 0; i < cnt; ++i) {
+            const Trace& trace = traces[base + i];
+            ip[i] = ((__uint128_t)trace.ip6_upper << 64) | trace.ip6_lower;
+
+            uint32_t topRange = static_cast<uint32_t>(trace.ip6_upper >> (64 - TOP_LEVEL_STRIDE));
+            uint32_t topIndex = topLevel.indexTable[topRange];
+            if (topIndex & (1ULL << 31)) {
+                out[base + i] = leaves[topIndex & ((1ULL << 31) - 1)];
+                currentNode[i] = nullptr;
+            } else {
+                currentNode[i] = &nodes[topIndex];
+                currentDepth[i] = TOP_LEVEL_STRIDE;
+                active++;
+            }
+        }
+
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                const InternalNode* node = currentNode[i];
+                if (node == nullptr) continue;
+
+                uint32_t range = extractBits(ip[i], currentDepth[i], node->stride);
+                uint32_t setBits = countSetBits(node, range);
+                if (isBitSet(node, range)) {
+                    currentDepth[i] += node->stride;
+                    currentNode[i] = &nodes[node->nodeBase + setBits - 1];
+                    active++;
+                } else {
+                    out[base + i] = leaves[node->leafBase + range - setBits];
+                    currentNode[i] = nullptr;
+                }
             }
         }
     }
 }
 
 uint64_t Poptrie::CalMemory() {
-    return totalMemory;
+    if (topLevel.indexTable == nullptr) return 0;
+    uint64_t total_mem = 0;
+    total_mem += sizeof(uint32_t) * (1ULL << TOP_LEVEL_STRIDE);
+    total_mem += sizeof(InternalNode) * (uint64_t)nodesCapacity;
+    total_mem += sizeof(uint32_t) * (uint64_t)leavesCapacity;
+    return total_mem;
+}
+
+// 快照: indexTable / nodes / leaves 只含下标, 原样写入, Load 后直接在只读映射上查找
+bool Poptrie::Save(const string &path) {
+    if (topLevel.indexTable == nullptr) {
+        cout << "Poptrie::Save() : trie is empty" << endl;
+        return false;
+    }
+    SnapshotWriter writer;
+    writer.params[0] = TOP_LEVEL_STRIDE;
+    writer.params[1] = nodesSize;
+    writer.params[2] = leavesSize;
+    writer.params[3] = writer.Append(topLevel.indexTable, sizeof(uint32_t) * (1ULL << TOP_LEVEL_STRIDE));
+    writer.params[4] = writer.Append(nodes, sizeof(InternalNode) * (uint64_t)nodesSize);
+    writer.params[5] = writer.Append(leaves, sizeof(uint32_t) * (uint64_t)leavesSize);
+    return writer.Write(path, "Poptrie");
+}
+
+bool Poptrie::Load(const string &path) {
+    SnapshotImage* image = new SnapshotImage;
+    if (!image->Open(path, "Poptrie")) {
+        delete image;
+        return false;
+    }
+    if (image->Param(0) != TOP_LEVEL_STRIDE) {
+        cout << "Poptrie::Load() : snapshot TOP_LEVEL_STRIDE " << image->Param(0) << " != " << (int)TOP_LEVEL_STRIDE << endl;
+        delete image;
+        return false;
+    }
+    if (!image->CheckParam(3, 1ULL << TOP_LEVEL_STRIDE, sizeof(uint32_t)) ||
+        !image->CheckParam(4, image->Param(1), sizeof(InternalNode)) ||
+        !image->CheckParam(5, image->Param(2), sizeof(uint32_t))) {
+        delete image;
+        return false;
+    }
+
+    clear();
+    snapshot = image;
+    nodesSize = nodesCapacity = image->Param(1);
+    leavesSize = leavesCapacity = image->Param(2);
+    topLevel.indexTable = image->At<uint32_t>(image->Param(3));
+    nodes = image->At<InternalNode>(image->Param(4));
+    leaves = image->At<uint32_t>(image->Param(5));
+    return true;
 }
\ No newline at end of file
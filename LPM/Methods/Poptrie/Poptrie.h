@@ -15,30 +15,40 @@ public:
     void Create(vector<Prefix*> &prefixes, ProgramState *ps) override;
     uint32_t Lookup(Trace *trace, ProgramState *ps) override;
     uint32_t Lookup(Trace *trace) override;
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out) override;
     uint64_t CalMemory() override;
+    bool Save(const string &path) override;
+    bool Load(const string &path) override;
 
 private:
     struct InternalNode {
-        uint8_t stride;            
         uint64_t bitVector[8];      
-        uint32_t* directResult;     
-        InternalNode* childNodes;   
+        uint32_t leafBase;          
+        uint32_t nodeBase;          
+        uint8_t stride;            
     };
 
+    // indexTable 最高位为 1 时低 31 位是 leaves 下标, 否则是 nodes 下标
     struct DirectPointer {
-        uint32_t* indexTable;     
-        uint32_t* directResult;   
-        InternalNode* internalNodes;
+        uint32_t* indexTable;       
     } topLevel;
 
-    static const uint8_t TOP_LEVEL_STRIDE; 
-    uint64_t totalMemory;                  
+    InternalNode* nodes;            
+    uint32_t nodesSize;
+    uint32_t nodesCapacity;
+    uint32_t* leaves;               
+    uint32_t leavesSize;
+    uint32_t leavesCapacity;
+    SnapshotImage* snapshot;        // Load 之后 nodes / leaves / indexTable 指向只读映射
 
-    void destroyInternalNode(InternalNode* node);
+    static const uint8_t TOP_LEVEL_STRIDE; 
+    uint32_t allocNodes(uint32_t count);
+    uint32_t allocLeaves(uint32_t count);
+    void shrinkArena();
     void clear();
 
     void buildTopLevel(const vector<Prefix*>& prefixes);
-    void buildInternalNode(InternalNode* node, const vector<Prefix*>& prefixes, uint8_t currentDepth);
+    void buildInternalNode(uint32_t nodeIndex, const vector<Prefix*>& prefixes, uint8_t currentDepth);
     unordered_map<uint32_t, vector<Prefix*>> groupPrefixesByRange(
         const vector<Prefix*>& prefixes, uint8_t currentDepth, uint8_t stride);
     inline uint32_t extractBits(__uint128_t ip, uint8_t offset, uint8_t length) const;
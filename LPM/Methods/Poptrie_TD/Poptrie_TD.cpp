@@ -2,13 +2,14 @@
 #include <algorithm>
 #include <cstring>
 #include <unordered_map>
+#include <omp.h>
 
 uint8_t Poptrie_TD::TOP_LEVEL_STRIDE = 16;
 
-Poptrie_TD::Poptrie_TD() : totalMemory(0) {
+Poptrie_TD::Poptrie_TD() : nodes(nullptr), nodesSize(0), nodesCapacity(0),
+                           leaves(nullptr), leavesSize(0), leavesCapacity(0),
+                           snapshot(nullptr), topInternalCount(0), garbageNodes(0), garbageLeaves(0) {
     topLevel.indexTable = nullptr;    
-    topLevel.directResult = nullptr;  
-    topLevel.internalNodes = nullptr; 
 }
 
 Poptrie_TD::~Poptrie_TD() {
@@ -16,58 +17,70 @@ Poptrie_TD::~Poptrie_TD() {
 }
 
 void Poptrie_TD::clear() {
-    if (topLevel.internalNodes != nullptr && topLevel.indexTable != nullptr) {
-        uint32_t topLevelSize = 1ULL << TOP_LEVEL_STRIDE; 
-        uint32_t internalNodeCount = 0;
-        
-        for (uint32_t i = 0; i < topLevelSize; ++i) {
-            if (!(topLevel.indexTable[i] & (1ULL << 31))) {
-                internalNodeCount++;
-            }
-        }
-        
-        for (uint32_t i = 0; i < internalNodeCount; ++i) {
-            destroyInternalNode(&topLevel.internalNodes[i]);
-        }
-        
-        delete[] topLevel.internalNodes;
-        topLevel.internalNodes = nullptr;
+    if (snapshot != nullptr) {
+        delete snapshot;
+        snapshot = nullptr;
+        topLevel.indexTable = nullptr;
+        nodes = nullptr;
+        leaves = nullptr;
     }
-    
+
     if (topLevel.indexTable != nullptr) {
         delete[] topLevel.indexTable;
         topLevel.indexTable = nullptr;
     }
-    
-    if (topLevel.directResult != nullptr) {
-        delete[] topLevel.directResult;
-        topLevel.directResult = nullptr;
-    }
 
-    totalMemory = 0;
-}
+    free(nodes);
+    nodes = nullptr;
+    nodesSize = nodesCapacity = 0;
 
+    free(leaves);
+    leaves = nullptr;
+    leavesSize = leavesCapacity = 0;
 
-void Poptrie_TD::destroyInternalNode(InternalNode* node) {
-    if (node == nullptr) return; 
-    
-    if (node->childNodes != nullptr) {
-        uint32_t childCount = 0;
-        for (int i = 0; i < 8; ++i) {
-            childCount += __builtin_popcountll(node->bitVector[i]);
+    longPrefixes.clear();
+    shortPrefixes.clear();
+    topInternalCount = garbageNodes = garbageLeaves = 0;
+}
+
+uint32_t Poptrie_TD::allocNodes(uint32_t count) {
+    uint32_t base = nodesSize;
+    if (nodesSize + count > nodesCapacity) {
+        nodesCapacity = max(nodesSize + count, max(nodesCapacity * 2, 1024U));
+        nodes = static_cast<InternalNode*>(realloc(nodes, sizeof(InternalNode) * nodesCapacity));
+        if (nodes == nullptr) {
+            cout << "Poptrie_TD::allocNodes() : out of memory" << endl;
+            exit(-1);
         }
-        
-        for (uint32_t i = 0; i < childCount; ++i) {
-            destroyInternalNode(&node->childNodes[i]);
+    }
+    memset(&nodes[base], 0, sizeof(InternalNode) * count);
+    nodesSize += count;
+    return base;
+}
+
+uint32_t Poptrie_TD::allocLeaves(uint32_t count) {
+    uint32_t base = leavesSize;
+    if (leavesSize + count > leavesCapacity) {
+        leavesCapacity = max(leavesSize + count, max(leavesCapacity * 2, 4096U));
+        leaves = static_cast<uint32_t*>(realloc(leaves, sizeof(uint32_t) * leavesCapacity));
+        if (leaves == nullptr) {
+            cout << "Poptrie_TD::allocLeaves() : out of memory" << endl;
+            exit(-1);
         }
+    }
+    memset(&leaves[base], 0, sizeof(uint32_t) * count);
+    leavesSize += count;
+    return base;
+}
 
-        delete[] node->childNodes;
-        node->childNodes = nullptr;
+void Poptrie_TD::shrinkArena() {
+    if (nodesSize > 0 && nodesSize < nodesCapacity) {
+        nodes = static_cast<InternalNode*>(realloc(nodes, sizeof(InternalNode) * nodesSize));
+        nodesCapacity = nodesSize;
     }
-    
-    if (node->directResult != nullptr) {
-        delete[] node->directResult;
-        node->directResult = nullptr;
+    if (leavesSize > 0 && leavesSize < leavesCapacity) {
+        leaves = static_cast<uint32_t*>(realloc(leaves, sizeof(uint32_t) * leavesSize));
+        leavesCapacity = leavesSize;
     }
 }
 
@@ -113,6 +126,14 @@ inline uint32_t Poptrie_TD::countSetBits(const InternalNode* node, uint32_t inde
     return count;
 }
 
+inline uint32_t Poptrie_TD::countChildren(const InternalNode* node) const {
+    uint32_t count = 0;
+    for (int i = 0; i < 8; ++i) {
+        count += __builtin_popcountll(node->bitVector[i]);
+    }
+    return count;
+}
+
 unordered_map<uint32_t, vector<Prefix*>> Poptrie_TD::groupPrefixesByRange(
     const vector<Prefix*>& prefixes, uint8_t currentDepth, uint8_t stride) {
     unordered_map<uint32_t, vector<Prefix*>> rangeToPrefixes;
@@ -137,9 +158,11 @@ unordered_map<uint32_t, vector<Prefix*>> Poptrie_TD::groupPrefixesByRange(
     return rangeToPrefixes;
 }
 
-void Poptrie_TD::buildInternalNode(InternalNode* node, const vector<Prefix*>& prefixes, 
+void Poptrie_TD::buildInternalNode(uint32_t nodeIndex, const vector<Prefix*>& prefixes, 
                                 uint8_t currentDepth, __uint128_t common_ip, double pop_score) {
     /* TopK */
+    InternalNode tmp;
+    InternalNode* node = &tmp;
     node->stride = 6;
     if (pop_score > 1.2) node->stride = 8;
     else if (pop_score > 1.0) node->stride = 8;
@@ -169,15 +192,10 @@ void Poptrie_TD::buildInternalNode(InternalNode* node, const vector<Prefix*>& pr
     }
 
     uint32_t directResultSize = totalRangeCount - childNodeCount; 
-    node->directResult = new uint32_t[directResultSize]();        
-    totalMemory += sizeof(uint32_t) * directResultSize;          
-    
-    node->childNodes = nullptr;
-    if (childNodeCount > 0) {
-        node->childNodes = new InternalNode[childNodeCount]();   
-        totalMemory += sizeof(InternalNode) * childNodeCount;    
-    }
-    
+    node->leafBase = allocLeaves(directResultSize);
+    node->nodeBase = childNodeCount > 0 ? allocNodes(childNodeCount) : 0;
+    nodes[nodeIndex] = tmp;
+
     uint32_t currentChildIdx = 0; 
     for (uint32_t range = 0; range < totalRangeCount; ++range) {
         auto it = rangeToPrefixes.find(range);
@@ -190,12 +208,12 @@ void Poptrie_TD::buildInternalNode(InternalNode* node, const vector<Prefix*>& pr
                 bestPort = rangePrefixes[0]->port;
             }
             if (directIndex < directResultSize) {
-                node->directResult[directIndex] = bestPort;
+                leaves[tmp.leafBase + directIndex] = bestPort;
             }
             continue;
         }
         
-        if (node->childNodes != nullptr && currentChildIdx < childNodeCount) {
+        if (currentChildIdx < childNodeCount) {
             /* 计算流行度 TopK*/
             __uint128_t _ip = common_ip | ((__uint128_t)range << (128 - currentDepth - stride));
             double total_trace_size = TSL::getTopKFreq(common_ip, currentDepth);
@@ -205,7 +223,7 @@ void Poptrie_TD::buildInternalNode(InternalNode* node, const vector<Prefix*>& pr
             expect_trace_size = total_trace_size / childNodeCount;
             if(expect_trace_size != 0) son_pop_score = sub_trace_size / expect_trace_size;
 
-            buildInternalNode(&node->childNodes[currentChildIdx], rangePrefixes, currentDepth + stride, _ip, son_pop_score);
+            buildInternalNode(tmp.nodeBase + currentChildIdx, rangePrefixes, currentDepth + stride, _ip, son_pop_score);
             currentChildIdx++; 
         }
     }
@@ -216,63 +234,72 @@ void Poptrie_TD::buildTopLevel(const vector<Prefix*>& prefixes) {
     
     auto rangeToPrefixes = groupPrefixesByRange(prefixes, 0, TOP_LEVEL_STRIDE);
     
-    uint32_t internalNodeCount = 0;
-    for (const auto& pair : rangeToPrefixes) {
-        const auto& rangePrefixes = pair.second;
-        if (!rangePrefixes.empty() && rangePrefixes[0]->prefix_len > TOP_LEVEL_STRIDE) {
-            internalNodeCount++;
-        }
-    }
-    
-    topLevel.indexTable = new uint32_t[topLevelSize](); 
-    totalMemory += sizeof(uint32_t) * topLevelSize;     
-    
-    uint32_t directResultSize = topLevelSize - internalNodeCount; 
-    topLevel.directResult = new uint32_t[directResultSize]();     
-    totalMemory += sizeof(uint32_t) * directResultSize;          
-    
-    topLevel.internalNodes = nullptr;
-    if (internalNodeCount > 0) {
-        topLevel.internalNodes = new InternalNode[internalNodeCount](); 
-        totalMemory += sizeof(InternalNode) * internalNodeCount;      
-    }
-
-    __uint128_t common_ip = 0;
+    topLevel.indexTable = new uint32_t[topLevelSize]();  
 
-    uint32_t currentInternalIdx = 0; 
+    vector<uint32_t> internalRanges;
+    vector<const vector<Prefix*>*> internalPrefixes;
     for (uint32_t range = 0; range < topLevelSize; ++range) {
         auto it = rangeToPrefixes.find(range);
-        const auto& rangePrefixes = (it != rangeToPrefixes.end()) ? it->second : vector<Prefix*>();
-        
-        if (rangePrefixes.empty() || rangePrefixes[0]->prefix_len <= TOP_LEVEL_STRIDE) {
-            uint32_t directIndex = range - currentInternalIdx;
-
+        if (it == rangeToPrefixes.end() || it->second.empty() || it->second[0]->prefix_len <= TOP_LEVEL_STRIDE) {
             uint32_t bestPort = 0;
-            if (!rangePrefixes.empty()) {
-                bestPort = rangePrefixes[0]->port;
+            if (it != rangeToPrefixes.end() && !it->second.empty()) {
+                bestPort = it->second[0]->port;
             }
 
-            topLevel.indexTable[range] = directIndex | (1ULL << 31);
-            if (directIndex < directResultSize) {
-                topLevel.directResult[directIndex] = bestPort;
-            }
+            topLevel.indexTable[range] = bestPort | (1ULL << 31);
             continue;
         }
-        
-        if (topLevel.internalNodes != nullptr && currentInternalIdx < internalNodeCount) {
-            __uint128_t _ip = common_ip | ((__uint128_t)range << (128 - TOP_LEVEL_STRIDE));
-            double total_trace_size = TSL::getTopKFreq(0, 0);
-            double sub_trace_size = TSL::getTopKFreq(_ip, TOP_LEVEL_STRIDE);
-            
-            double expect_trace_size = 0, pop_score = 0;
-            expect_trace_size = total_trace_size / internalNodeCount;
-            if(expect_trace_size != 0) pop_score = sub_trace_size / expect_trace_size;
-            
-            topLevel.indexTable[range] = currentInternalIdx;
-            buildInternalNode(&topLevel.internalNodes[currentInternalIdx], rangePrefixes, TOP_LEVEL_STRIDE, _ip, pop_score);
-            currentInternalIdx++;
+        internalRanges.push_back(range);
+        internalPrefixes.push_back(&it->second);
+    }
+    
+    uint32_t internalNodeCount = internalRanges.size();
+    double total_trace_size = TSL::getTopKFreq(0, 0);
+    double expect_trace_size = internalNodeCount > 0 ? total_trace_size / internalNodeCount : 0;
+
+    // 各顶层区间的子树互不依赖: 每个线程建到自己的 arena 中, 最后合并并重定位 leafBase / nodeBase
+    int threads = omp_get_max_threads();
+    vector<Poptrie_TD> builders(threads);
+    vector<uint32_t> rootIndex(internalNodeCount), rootOwner(internalNodeCount);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < (int)internalNodeCount; ++i) {
+        int tid = omp_get_thread_num();
+        Poptrie_TD& builder = builders[tid];
+
+        __uint128_t _ip = (__uint128_t)internalRanges[i] << (128 - TOP_LEVEL_STRIDE);
+        double sub_trace_size = TSL::getTopKFreq(_ip, TOP_LEVEL_STRIDE);
+        double pop_score = 0;
+        if(expect_trace_size != 0) pop_score = sub_trace_size / expect_trace_size;
+
+        rootIndex[i] = builder.allocNodes(1);
+        rootOwner[i] = tid;
+        builder.buildInternalNode(rootIndex[i], *internalPrefixes[i], TOP_LEVEL_STRIDE, _ip, pop_score);
+    }
+
+    vector<uint32_t> nodeOffset(threads, 0);
+    for (int tid = 0; tid < threads; ++tid) {
+        Poptrie_TD& builder = builders[tid];
+        if (builder.nodesSize == 0) continue;
+
+        uint32_t nodeBase = allocNodes(builder.nodesSize);
+        uint32_t leafBase = builder.leavesSize > 0 ? allocLeaves(builder.leavesSize) : leavesSize;
+        memcpy(&nodes[nodeBase], builder.nodes, sizeof(InternalNode) * builder.nodesSize);
+        if (builder.leavesSize > 0) {
+            memcpy(&leaves[leafBase], builder.leaves, sizeof(uint32_t) * builder.leavesSize);
+        }
+        for (uint32_t i = nodeBase; i < nodeBase + builder.nodesSize; ++i) {
+            nodes[i].leafBase += leafBase;
+            if (countChildren(&nodes[i]) > 0) nodes[i].nodeBase += nodeBase;
         }
+        nodeOffset[tid] = nodeBase;
+        builder.clear();
     }
+
+    for (uint32_t i = 0; i < internalNodeCount; ++i) {
+        topLevel.indexTable[internalRanges[i]] = nodeOffset[rootOwner[i]] + rootIndex[i];
+    }
+    topInternalCount = internalNodeCount;
 }
 
 void Poptrie_TD::Create(vector<Prefix*> &prefixes, ProgramState *ps) {
@@ -288,7 +315,21 @@ void Poptrie_TD::Create(vector<Prefix*> &prefixes, ProgramState *ps) {
             return a->prefix_len > b->prefix_len;
         });
 
+    shortPrefixes.resize(TOP_LEVEL_STRIDE + 1);
+    for (auto prefix : prefixes) {
+        Prefix entry = *prefix;
+        __uint128_t ip = trim_prefix(((__uint128_t)entry.ip6_upper << 64) | entry.ip6_lower, entry.prefix_len);
+        entry.ip6_upper = (uint64_t)(ip >> 64);
+        entry.ip6_lower = (uint64_t)ip;
+        if (entry.prefix_len > TOP_LEVEL_STRIDE) {
+            longPrefixes[extractBits(ip, 0, TOP_LEVEL_STRIDE)].push_back(entry);
+        } else {
+            shortPrefixes[entry.prefix_len].insert({extractBits(ip, 0, entry.prefix_len), entry.port});
+        }
+    }
+
     buildTopLevel(prefixes);
+    shrinkArena();
 }
 
 uint32_t Poptrie_TD::Lookup(Trace *trace, ProgramState *ps) {
@@ -302,12 +343,10 @@ uint32_t Poptrie_TD::Lookup(Trace *trace, ProgramState *ps) {
     uint32_t topIndex = topLevel.indexTable[topRange];
     
     if (topIndex & (1ULL << 31)) {
-        ps->lookup_access.Addcount();
-        uint32_t directIndex = topIndex & ((1ULL << 31) - 1); 
-        resultPort = topLevel.directResult[directIndex];
+        resultPort = topIndex & ((1ULL << 31) - 1); 
         ps->lookup_depth.Addcount();
     } else {
-        InternalNode* currentNode = &topLevel.internalNodes[topIndex]; 
+        const InternalNode* currentNode = &nodes[topIndex]; 
         uint8_t currentDepth = TOP_LEVEL_STRIDE; 
         ps->lookup_depth.Addcount();
         
@@ -318,12 +357,12 @@ uint32_t Poptrie_TD::Lookup(Trace *trace, ProgramState *ps) {
                 ps->lookup_access.Addcount();
                 uint32_t childIndex = countSetBits(currentNode, range) - 1; 
                 currentDepth += currentNode->stride;                        
-                currentNode = &currentNode->childNodes[childIndex];         
+                currentNode = &nodes[currentNode->nodeBase + childIndex];         
                 ps->lookup_depth.Addcount();                                
             } else {
                 ps->lookup_access.Addcount(); 
                 uint32_t directIndex = range - countSetBits(currentNode, range);
-                resultPort = currentNode->directResult[directIndex];
+                resultPort = leaves[currentNode->leafBase + directIndex];
                 break; 
             }
         }
@@ -343,10 +382,9 @@ uint32_t Poptrie_TD::Lookup(Trace *trace) {
     uint32_t topIndex = topLevel.indexTable[topRange];
     
     if (topIndex & (1ULL << 31)) {
-        uint32_t directIndex = topIndex & ((1ULL << 31) - 1);
-        return topLevel.directResult[directIndex];
+        return topIndex & ((1ULL << 31) - 1);
     } else {
-        InternalNode* currentNode = &topLevel.internalNodes[topIndex];
+        const InternalNode* currentNode = &nodes[topIndex];
         uint8_t currentDepth = TOP_LEVEL_STRIDE;
         
         while (true) {
@@ -355,15 +393,439 @@ uint32_t Poptrie_TD::Lookup(Trace *trace) {
             if (isBitSet(currentNode, range)) {
                 uint32_t childIndex = countSetBits(currentNode, range) - 1;
                 currentDepth += currentNode->stride;
-                currentNode = &currentNode->childNodes[childIndex];
+                currentNode = &nodes[currentNode->nodeBase + childIndex];
             } else {
                 uint32_t directIndex = range - countSetBits(currentNode, range);
-                return currentNode->directResult[directIndex];
+                return leaves[currentNode->leafBase + directIndex];
+            }
+        }
+    }
+}
+
+void Poptrie_TD::LookupBatch(const Trace *traces, size_t n, uint32_t *out) {
+    if (topLevel.indexTable == nullptr) {
+        for (size_t i = 0; i < n; ++i) out[i] = 0;
+        return;
+    }
+
+    __uint128_t ip[LOOKUP_BATCH_WIDTH];
+    const InternalNode* currentNode[LOOKUP_BATCH_WIDTH];
+    uint8_t currentDepth[LOOKUP_BATCH_WIDTH];
+
+    for (size_t base = 0; base < n; base += LOOKUP_BATCH_WIDTH) {
+        const size_t cnt = min((size_t)LOOKUP_BATCH_WIDTH, n - base);
+        size_t active = 0;
+
+        for (size_t i = 0; i < cnt; ++i) {
+            const Trace& trace = traces[base + i];
+            ip[i] = ((__uint128_t)trace.ip6_upper << 64) | trace.ip6_lower;
+
+            uint32_t topRange = static_cast<uint32_t>(trace.ip6_upper >> (64 - TOP_LEVEL_STRIDE));
+            uint32_t topIndex = topLevel.indexTable[topRange];
+            if (topIndex & (1ULL << 31)) {
+                out[base + i] = topIndex & ((1ULL << 31) - 1);
+                currentNode[i] = nullptr;
+            } else {
+                currentNode[i] = &nodes[topIndex];
+                currentDepth[i] = TOP_LEVEL_STRIDE;
+                active++;
+            }
+        }
+
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < cnt; ++i) {
+                const InternalNode* node = currentNode[i];
+                if (node == nullptr) continue;
+
+                uint32_t range = extractBits(ip[i], currentDepth[i], node->stride);
+                uint32_t setBits = countSetBits(node, range);
+                if (isBitSet(node, range)) {
+                    currentDepth[i] += node->stride;
+                    currentNode[i] = &nodes[node->nodeBase + setBits - 1];
+                    active++;
+                } else {
+                    out[base + i] = leaves[node->leafBase + range - setBits];
+                    currentNode[i] = nullptr;
+                }
             }
         }
     }
 }
 
 uint64_t Poptrie_TD::CalMemory() {
-    return totalMemory;
+    if (topLevel.indexTable == nullptr) return 0;
+    uint64_t total_mem = 0;
+    total_mem += sizeof(uint32_t) * (1ULL << TOP_LEVEL_STRIDE);
+    total_mem += sizeof(InternalNode) * (uint64_t)nodesCapacity;
+    total_mem += sizeof(uint32_t) * (uint64_t)leavesCapacity;
+    return total_mem;
+}
+
+// 快照: 除 arena 外还保存增量更新用的前缀表 (长前缀保持桶内顺序, 短前缀还原成 Prefix)
+bool Poptrie_TD::Save(const string &path) {
+    if (topLevel.indexTable == nullptr) {
+        cout << "Poptrie_TD::Save() : trie is empty" << endl;
+        return false;
+    }
+    if (snapshot != nullptr) detachSnapshot();
+
+    vector<Prefix> saved;
+    for (auto& bucket : longPrefixes) {
+        saved.insert(saved.end(), bucket.second.begin(), bucket.second.end());
+    }
+    for (uint32_t len = 0; len < shortPrefixes.size(); ++len) {
+        for (auto& it : shortPrefixes[len]) {
+            __uint128_t ip = len == 0 ? 0 : (__uint128_t)it.first << (128 - len);
+            saved.push_back((Prefix){(uint64_t)(ip >> 64), (uint64_t)ip, (uint8_t)len, it.second});
+        }
+    }
+
+    SnapshotWriter writer;
+    writer.params[0] = TOP_LEVEL_STRIDE;
+    writer.params[1] = nodesSize;
+    writer.params[2] = leavesSize;
+    writer.params[3] = topInternalCount;
+    writer.params[4] = garbageNodes;
+    writer.params[5] = garbageLeaves;
+    writer.params[6] = saved.size();
+    writer.params[7] = writer.Append(topLevel.indexTable, sizeof(uint32_t) * (1ULL << TOP_LEVEL_STRIDE));
+    writer.params[8] = writer.Append(nodes, sizeof(InternalNode) * (uint64_t)nodesSize);
+    writer.params[9] = writer.Append(leaves, sizeof(uint32_t) * (uint64_t)leavesSize);
+    writer.params[10] = writer.Append(saved.data(), sizeof(Prefix) * saved.size());
+    return writer.Write(path, "Poptrie_TD");
+}
+
+bool Poptrie_TD::Load(const string &path) {
+    SnapshotImage* image = new SnapshotImage;
+    if (!image->Open(path, "Poptrie_TD")) {
+        delete image;
+        return false;
+    }
+    if (image->Param(0) != TOP_LEVEL_STRIDE) {
+        cout << "Poptrie_TD::Load() : snapshot TOP_LEVEL_STRIDE " << image->Param(0) << " != " << (int)TOP_LEVEL_STRIDE << endl;
+        delete image;
+        return false;
+    }
+    if (!image->CheckParam(7, 1ULL << TOP_LEVEL_STRIDE, sizeof(uint32_t)) ||
+        !image->CheckParam(8, image->Param(1), sizeof(InternalNode)) ||
+        !image->CheckParam(9, image->Param(2), sizeof(uint32_t)) ||
+        !image->CheckParam(10, image->Param(6), sizeof(Prefix))) {
+        delete image;
+        return false;
+    }
+
+    clear();
+    snapshot = image;
+    nodesSize = nodesCapacity = image->Param(1);
+    leavesSize = leavesCapacity = image->Param(2);
+    topInternalCount = image->Param(3);
+    garbageNodes = image->Param(4);
+    garbageLeaves = image->Param(5);
+    topLevel.indexTable = image->At<uint32_t>(image->Param(7));
+    nodes = image->At<InternalNode>(image->Param(8));
+    leaves = image->At<uint32_t>(image->Param(9));
+    return true;
+}
+
+// 映射是只读的: 第一次增量更新前把 arena 拷到堆上, 并从快照恢复前缀表
+void Poptrie_TD::detachSnapshot() {
+    SnapshotImage* image = snapshot;
+    snapshot = nullptr;
+
+    uint32_t* indexTable = new uint32_t[1ULL << TOP_LEVEL_STRIDE];
+    memcpy(indexTable, topLevel.indexTable, sizeof(uint32_t) * (1ULL << TOP_LEVEL_STRIDE));
+    topLevel.indexTable = indexTable;
+
+    InternalNode* heapNodes = static_cast<InternalNode*>(malloc(sizeof(InternalNode) * max(nodesSize, 1U)));
+    uint32_t* heapLeaves = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * max(leavesSize, 1U)));
+    if (heapNodes == nullptr || heapLeaves == nullptr) {
+        cout << "Poptrie_TD::detachSnapshot() : out of memory" << endl;
+        exit(-1);
+    }
+    memcpy(heapNodes, nodes, sizeof(InternalNode) * nodesSize);
+    memcpy(heapLeaves, leaves, sizeof(uint32_t) * leavesSize);
+    nodes = heapNodes;
+    leaves = heapLeaves;
+
+    const Prefix* saved = image->At<Prefix>(image->Param(10));
+    longPrefixes.clear();
+    shortPrefixes.assign(TOP_LEVEL_STRIDE + 1, unordered_map<uint32_t, uint32_t>());
+    for (uint64_t i = 0; i < image->Param(6); ++i) {
+        const Prefix& entry = saved[i];
+        __uint128_t ip = ((__uint128_t)entry.ip6_upper << 64) | entry.ip6_lower;
+        if (entry.prefix_len > TOP_LEVEL_STRIDE) {
+            longPrefixes[extractBits(ip, 0, TOP_LEVEL_STRIDE)].push_back(entry);
+        } else {
+            shortPrefixes[entry.prefix_len].insert({extractBits(ip, 0, entry.prefix_len), entry.port});
+        }
+    }
+    delete image;
+}
+
+int Poptrie_TD::findShortPrefix(uint32_t range, uint32_t &port) const {
+    for (int len = TOP_LEVEL_STRIDE; len >= 0; --len) {
+        const auto& table = shortPrefixes[len];
+        if (table.empty()) continue;
+        auto it = table.find(range >> (TOP_LEVEL_STRIDE - len));
+        if (it != table.end()) {
+            port = it->second;
+            return len;
+        }
+    }
+    port = 0;
+    return -1;
+}
+
+void Poptrie_TD::releaseSubtree(uint32_t nodeIndex) {
+    const InternalNode* node = &nodes[nodeIndex];
+    uint32_t childCount = countChildren(node);
+    garbageNodes += 1;
+    garbageLeaves += (1U << node->stride) - childCount;
+    for (uint32_t i = 0; i < childCount; ++i) {
+        releaseSubtree(node->nodeBase + i);
+    }
+}
+
+void Poptrie_TD::rebuildTopRange(uint32_t range) {
+    uint32_t oldIndex = topLevel.indexTable[range];
+    if (!(oldIndex & (1ULL << 31))) {
+        releaseSubtree(oldIndex);
+        topInternalCount--;
+    }
+
+    uint32_t shortPort = 0;
+    int shortLen = findShortPrefix(range, shortPort);
+
+    auto it = longPrefixes.find(range);
+    if (it == longPrefixes.end() || it->second.empty()) {
+        if (it != longPrefixes.end()) longPrefixes.erase(it);
+        topLevel.indexTable[range] = shortPort | (1ULL << 31);
+        return;
+    }
+
+    vector<Prefix*> rangePrefixes;
+    for (auto& prefix : it->second) {
+        rangePrefixes.push_back(&prefix);
+    }
+    // 顶层以内的前缀覆盖整个子树, 只需要最长的一个作为缺省下一跳
+    Prefix shortPrefix;
+    if (shortLen >= 0) {
+        shortPrefix.ip6_upper = (uint64_t)range << (64 - TOP_LEVEL_STRIDE);
+        shortPrefix.ip6_lower = 0;
+        shortPrefix.prefix_len = shortLen;
+        shortPrefix.port = shortPort;
+        rangePrefixes.push_back(&shortPrefix);
+    }
+
+    topInternalCount++;
+    __uint128_t _ip = (__uint128_t)range << (128 - TOP_LEVEL_STRIDE);
+    double total_trace_size = TSL::getTopKFreq(0, 0);
+    double sub_trace_size = TSL::getTopKFreq(_ip, TOP_LEVEL_STRIDE);
+
+    double expect_trace_size = 0, pop_score = 0;
+    expect_trace_size = total_trace_size / topInternalCount;
+    if(expect_trace_size != 0) pop_score = sub_trace_size / expect_trace_size;
+
+    uint32_t nodeIndex = allocNodes(1);
+    buildInternalNode(nodeIndex, rangePrefixes, TOP_LEVEL_STRIDE, _ip, pop_score);
+    topLevel.indexTable[range] = nodeIndex;
+}
+
+void Poptrie_TD::rebuildLongPrefix(uint32_t range, __uint128_t ip, uint8_t prefix_len) {
+    uint32_t topIndex = topLevel.indexTable[range];
+    auto bucket = longPrefixes.find(range);
+    if ((topIndex & (1ULL << 31)) || bucket == longPrefixes.end() || bucket->second.empty()) {
+        rebuildTopRange(range);
+        return;
+    }
+
+    // 沿前缀路径下降到最深的、更新后仍为内部节点且包含该前缀的节点, 只重建该节点
+    uint32_t nodeIndex = topIndex;
+    uint8_t currentDepth = TOP_LEVEL_STRIDE;
+    __uint128_t common_ip = trim_prefix(ip, TOP_LEVEL_STRIDE);
+    __uint128_t parent_ip = 0;
+    uint8_t parentDepth = 0;
+    uint32_t siblingCount = topInternalCount;
+
+    while (true) {
+        const InternalNode* node = &nodes[nodeIndex];
+        uint8_t childDepth = currentDepth + node->stride;
+        if (prefix_len <= childDepth) break;
+
+        uint32_t childRange = extractBits(ip, currentDepth, node->stride);
+        if (!isBitSet(node, childRange)) break;
+
+        __uint128_t child_ip = trim_prefix(ip, childDepth);
+        bool childInternal = false;
+        for (const auto& prefix : bucket->second) {
+            if (prefix.prefix_len <= childDepth) break;
+            __uint128_t prefixIp = ((__uint128_t)prefix.ip6_upper << 64) | prefix.ip6_lower;
+            if (trim_prefix(prefixIp, childDepth) == child_ip) {
+                childInternal = true;
+                break;
+            }
+        }
+        if (!childInternal) break;
+
+        parent_ip = common_ip;
+        parentDepth = currentDepth;
+        siblingCount = countChildren(node);
+        nodeIndex = node->nodeBase + countSetBits(node, childRange) - 1;
+        currentDepth = childDepth;
+        common_ip = child_ip;
+    }
+
+    vector<Prefix*> nodePrefixes;
+    for (auto& prefix : bucket->second) {
+        __uint128_t prefixIp = ((__uint128_t)prefix.ip6_upper << 64) | prefix.ip6_lower;
+        bool covered = prefix.prefix_len >= currentDepth ? 
+            trim_prefix(prefixIp, currentDepth) == common_ip : 
+            trim_prefix(common_ip, prefix.prefix_len) == prefixIp;
+        if (covered) nodePrefixes.push_back(&prefix);
+    }
+    Prefix shortPrefix;
+    uint32_t shortPort = 0;
+    int shortLen = findShortPrefix(range, shortPort);
+    if (shortLen >= 0) {
+        shortPrefix.ip6_upper = (uint64_t)range << (64 - TOP_LEVEL_STRIDE);
+        shortPrefix.ip6_lower = 0;
+        shortPrefix.prefix_len = shortLen;
+        shortPrefix.port = shortPort;
+        nodePrefixes.push_back(&shortPrefix);
+    }
+
+    double total_trace_size = TSL::getTopKFreq(parent_ip, parentDepth);
+    double sub_trace_size = TSL::getTopKFreq(common_ip, currentDepth);
+    double expect_trace_size = 0, pop_score = 0;
+    expect_trace_size = total_trace_size / siblingCount;
+    if(expect_trace_size != 0) pop_score = sub_trace_size / expect_trace_size;
+
+    // 节点自身的槽位原地复用, 只回收其下的子节点与叶子
+    releaseSubtree(nodeIndex);
+    garbageNodes--;
+    buildInternalNode(nodeIndex, nodePrefixes, currentDepth, common_ip, pop_score);
+}
+
+void Poptrie_TD::updateShortRanges(uint8_t prefix_len, uint32_t key) {
+    const uint32_t span = 1U << (TOP_LEVEL_STRIDE - prefix_len);
+    const uint32_t first = key << (TOP_LEVEL_STRIDE - prefix_len);
+    for (uint32_t range = first; range < first + span; ++range) {
+        uint32_t port;
+        // 只有被更长的顶层前缀覆盖的区间不受影响
+        if (findShortPrefix(range, port) <= prefix_len) {
+            rebuildTopRange(range);
+        }
+    }
+}
+
+void Poptrie_TD::copySubtree(const InternalNode* oldNodes, const uint32_t* oldLeaves, uint32_t oldIndex, uint32_t newIndex) {
+    InternalNode node = oldNodes[oldIndex];
+    uint32_t childCount = countChildren(&node);
+    uint32_t leafCount = (1U << node.stride) - childCount;
+
+    uint32_t leafBase = allocLeaves(leafCount);
+    memcpy(&leaves[leafBase], &oldLeaves[node.leafBase], sizeof(uint32_t) * leafCount);
+    uint32_t nodeBase = childCount > 0 ? allocNodes(childCount) : 0;
+
+    uint32_t oldNodeBase = node.nodeBase;
+    node.leafBase = leafBase;
+    node.nodeBase = nodeBase;
+    nodes[newIndex] = node;
+
+    for (uint32_t i = 0; i < childCount; ++i) {
+        copySubtree(oldNodes, oldLeaves, oldNodeBase + i, nodeBase + i);
+    }
+}
+
+void Poptrie_TD::compactArena() {
+    InternalNode* oldNodes = nodes;
+    uint32_t* oldLeaves = leaves;
+    nodes = nullptr;
+    leaves = nullptr;
+    nodesSize = nodesCapacity = 0;
+    leavesSize = leavesCapacity = 0;
+
+    uint32_t topLevelSize = 1ULL << TOP_LEVEL_STRIDE;
+    for (uint32_t range = 0; range < topLevelSize; ++range) {
+        uint32_t oldIndex = topLevel.indexTable[range];
+        if (oldIndex & (1ULL << 31)) continue;
+        uint32_t newIndex = allocNodes(1);
+        copySubtree(oldNodes, oldLeaves, oldIndex, newIndex);
+        topLevel.indexTable[range] = newIndex;
+    }
+
+    free(oldNodes);
+    free(oldLeaves);
+    garbageNodes = garbageLeaves = 0;
+}
+
+bool Poptrie_TD::Insert(Prefix *prefix) {
+    if (topLevel.indexTable == nullptr) return false;
+    if (snapshot != nullptr) detachSnapshot();
+
+    Prefix entry = *prefix;
+    __uint128_t ip = trim_prefix(((__uint128_t)entry.ip6_upper << 64) | entry.ip6_lower, entry.prefix_len);
+    entry.ip6_upper = (uint64_t)(ip >> 64);
+    entry.ip6_lower = (uint64_t)ip;
+
+    if (entry.prefix_len > TOP_LEVEL_STRIDE) {
+        uint32_t range = extractBits(ip, 0, TOP_LEVEL_STRIDE);
+        auto& bucket = longPrefixes[range];
+        auto it = bucket.begin();
+        while (it != bucket.end() && it->prefix_len > entry.prefix_len) ++it;
+        for (; it != bucket.end() && it->prefix_len == entry.prefix_len; ++it) {
+            if (it->ip6_upper == entry.ip6_upper && it->ip6_lower == entry.ip6_lower) break;
+        }
+        if (it != bucket.end() && it->prefix_len == entry.prefix_len) {
+            if (it->port == entry.port) return true;
+            it->port = entry.port;
+        } else {
+            bucket.insert(it, entry);
+        }
+        rebuildLongPrefix(range, ip, entry.prefix_len);
+    } else {
+        uint32_t key = extractBits(ip, 0, entry.prefix_len);
+        auto& table = shortPrefixes[entry.prefix_len];
+        auto it = table.find(key);
+        if (it != table.end() && it->second == entry.port) return true;
+        table[key] = entry.port;
+        updateShortRanges(entry.prefix_len, key);
+    }
+
+    if (garbageNodes > (nodesSize >> 1) || garbageLeaves > (leavesSize >> 1)) {
+        compactArena();
+    }
+    return true;
+}
+
+bool Poptrie_TD::Delete(Prefix *prefix) {
+    if (topLevel.indexTable == nullptr) return false;
+    if (snapshot != nullptr) detachSnapshot();
+
+    __uint128_t ip = trim_prefix(((__uint128_t)prefix->ip6_upper << 64) | prefix->ip6_lower, prefix->prefix_len);
+
+    if (prefix->prefix_len > TOP_LEVEL_STRIDE) {
+        uint32_t range = extractBits(ip, 0, TOP_LEVEL_STRIDE);
+        auto bucket = longPrefixes.find(range);
+        if (bucket == longPrefixes.end()) return false;
+
+        auto it = bucket->second.begin();
+        for (; it != bucket->second.end(); ++it) {
+            if (it->prefix_len == prefix->prefix_len && 
+                it->ip6_upper == (uint64_t)(ip >> 64) && it->ip6_lower == (uint64_t)ip) break;
+        }
+        if (it == bucket->second.end()) return false;
+        bucket->second.erase(it);
+        rebuildLongPrefix(range, ip, prefix->prefix_len);
+    } else {
+        uint32_t key = extractBits(ip, 0, prefix->prefix_len);
+        if (shortPrefixes[prefix->prefix_len].erase(key) == 0) return false;
+        updateShortRanges(prefix->prefix_len, key);
+    }
+
+    if (garbageNodes > (nodesSize >> 1) || garbageLeaves > (leavesSize >> 1)) {
+        compactArena();
+    }
+    return true;
 }
\ No newline at end of file
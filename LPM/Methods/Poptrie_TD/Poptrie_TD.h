@@ -15,37 +15,66 @@ public:
     void Create(vector<Prefix*> &prefixes, ProgramState *ps) override;
     uint32_t Lookup(Trace *trace, ProgramState *ps) override;
     uint32_t Lookup(Trace *trace) override;
+    void LookupBatch(const Trace *traces, size_t n, uint32_t *out) override;
     uint64_t CalMemory() override;
+    bool Save(const string &path) override;
+    bool Load(const string &path) override;
+    bool Insert(Prefix *prefix) override;
+    bool Delete(Prefix *prefix) override;
 
     static uint8_t TOP_LEVEL_STRIDE;  
 
 private:
     struct InternalNode {
+        uint64_t bitVector[8];      
+        uint32_t leafBase;          
+        uint32_t nodeBase;          
         uint8_t stride;            
-        uint64_t bitVector[8];     
-        uint32_t* directResult;     
-        InternalNode* childNodes;   
     };
 
+    // indexTable 最高位为 1 时低 31 位直接是下一跳, 否则是 nodes 下标
     struct DirectPointer {
         uint32_t* indexTable;       
-        uint32_t* directResult;     
-        InternalNode* internalNodes;
     } topLevel;
 
-    uint64_t totalMemory;                   
+    InternalNode* nodes;            
+    uint32_t nodesSize;
+    uint32_t nodesCapacity;
+    uint32_t* leaves;               
+    uint32_t leavesSize;
+    uint32_t leavesCapacity;
+    SnapshotImage* snapshot;        // Load 之后 nodes / leaves / indexTable 指向只读映射
 
-    void destroyInternalNode(InternalNode* node);
+    // 增量更新: 长于 TOP_LEVEL_STRIDE 的前缀按顶层区间分桶 (长度降序), 其余按长度分表
+    unordered_map<uint32_t, vector<Prefix>> longPrefixes;
+    vector<unordered_map<uint32_t, uint32_t>> shortPrefixes;
+    uint32_t topInternalCount;
+    uint32_t garbageNodes;
+    uint32_t garbageLeaves;
+
+    uint32_t allocNodes(uint32_t count);
+    uint32_t allocLeaves(uint32_t count);
+    void shrinkArena();
     void clear();
+    void detachSnapshot();
+
+    int findShortPrefix(uint32_t range, uint32_t &port) const;
+    void updateShortRanges(uint8_t prefix_len, uint32_t key);
+    void rebuildTopRange(uint32_t range);
+    void rebuildLongPrefix(uint32_t range, __uint128_t ip, uint8_t prefix_len);
+    void releaseSubtree(uint32_t nodeIndex);
+    void copySubtree(const InternalNode* oldNodes, const uint32_t* oldLeaves, uint32_t oldIndex, uint32_t newIndex);
+    void compactArena();
 
     void buildTopLevel(const vector<Prefix*>& prefixes);
-    void buildInternalNode(InternalNode* node, const vector<Prefix*>& prefixes, uint8_t currentDepth, __uint128_t common_ip, double pop_score);
+    void buildInternalNode(uint32_t nodeIndex, const vector<Prefix*>& prefixes, uint8_t currentDepth, __uint128_t common_ip, double pop_score);
     unordered_map<uint32_t, vector<Prefix*>> groupPrefixesByRange(
         const vector<Prefix*>& prefixes, uint8_t currentDepth, uint8_t stride);
     inline uint32_t extractBits(__uint128_t ip, uint8_t offset, uint8_t length) const;
     inline bool isBitSet(const InternalNode* node, uint32_t index) const;
     inline void setBit(InternalNode* node, uint32_t index);
     inline uint32_t countSetBits(const InternalNode* node, uint32_t index) const;
+    inline uint32_t countChildren(const InternalNode* node) const;
 };
 
 #endif // POPTRIE_H
\ No newline at end of file
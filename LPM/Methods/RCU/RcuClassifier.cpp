@@ -0,0 +1,205 @@
+#include "RcuClassifier.h"
+
+static tuple<uint64_t, uint64_t, uint8_t> route_key(const Prefix *prefix) {
+    __uint128_t ip = trim_prefix(((__uint128_t)prefix->ip6_upper << 64) | prefix->ip6_lower, prefix->prefix_len);
+    return make_tuple((uint64_t)(ip >> 64), (uint64_t)ip, prefix->prefix_len);
+}
+
+RcuClassifier::RcuClassifier(function<Classifier*()> factory, vector<Prefix*> &prefixs, bool incremental)
+    : factory(factory), incremental(incremental), standby(NULL), global_epoch(1), reader_num(0) {
+    last_publish_time = last_grace_time = 0;
+    last_current_access = last_candidate_access = 0;
+    for (int i = 0; i < RCU_MAX_READERS; ++i) {
+        slots[i].epoch.store(0);
+    }
+
+    for (auto prefix : prefixs) {
+        routes.insert({route_key(prefix), prefix->port});
+    }
+
+    Classifier *classifier = factory();
+    classifier->Create(prefixs, &build_ps);
+    current.store(classifier);
+
+    if (incremental) {
+        standby = factory();
+        standby->Create(prefixs, &build_ps);
+    }
+}
+
+RcuClassifier::~RcuClassifier() {
+    delete current.load();
+    if (standby) delete standby;
+}
+
+int RcuClassifier::RegisterReader() {
+    int reader = reader_num.fetch_add(1);
+    if (reader >= RCU_MAX_READERS) {
+        cout << "RcuClassifier::RegisterReader() : too many readers !!!" << endl;
+        exit(1);
+    }
+    return reader;
+}
+
+void RcuClassifier::ReadLock(int reader) {
+    // seq_cst 保证 epoch 的发布先于随后对 current 的读取
+    slots[reader].epoch.store(global_epoch.load(memory_order_acquire), memory_order_seq_cst);
+}
+
+void RcuClassifier::ReadUnlock(int reader) {
+    slots[reader].epoch.store(0, memory_order_release);
+}
+
+uint32_t RcuClassifier::Lookup(int reader, Trace *trace) {
+    ReadLock(reader);
+    uint32_t port = current.load(memory_order_seq_cst)->Lookup(trace);
+    ReadUnlock(reader);
+    return port;
+}
+
+void RcuClassifier::LookupBatch(int reader, const Trace *traces, size_t n, uint32_t *out) {
+    ReadLock(reader);
+    current.load(memory_order_seq_cst)->LookupBatch(traces, n, out);
+    ReadUnlock(reader);
+}
+
+void RcuClassifier::Synchronize() {
+    uint64_t target = global_epoch.fetch_add(1, memory_order_seq_cst) + 1;
+    int readers = min(reader_num.load(), RCU_MAX_READERS);
+    for (int i = 0; i < readers; ++i) {
+        while (true) {
+            // 与 ReadLock 构成 store-load 对: 写者 exchange current 后读 slot, 读者写 slot 后读 current,
+            // 两边都用 seq_cst 才能保证至少一方看到对方, 不依赖 x86 上 fetch_add 的全屏障
+            uint64_t epoch = slots[i].epoch.load(memory_order_seq_cst);
+            if (epoch == 0 || epoch >= target) break;
+            this_thread::yield();
+        }
+    }
+}
+
+void RcuClassifier::ApplyRoutes(const PrefixUpdate *updates, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (updates[i].withdraw) routes.erase(route_key(&updates[i].prefix));
+        else routes[route_key(&updates[i].prefix)] = updates[i].prefix.port;
+    }
+}
+
+Classifier* RcuClassifier::Rebuild() {
+    vector<Prefix> storage;
+    storage.reserve(routes.size());
+    for (auto &route : routes) {
+        Prefix prefix;
+        prefix.ip6_upper = get<0>(route.first);
+        prefix.ip6_lower = get<1>(route.first);
+        prefix.prefix_len = get<2>(route.first);
+        prefix.port = route.second;
+        storage.push_back(prefix);
+    }
+    vector<Prefix*> prefixs;
+    for (auto &prefix : storage) {
+        prefixs.push_back(&prefix);
+    }
+
+    Classifier *classifier = factory();
+    classifier->Create(prefixs, &build_ps);
+    return classifier;
+}
+
+void RcuClassifier::Update(const PrefixUpdate *updates, size_t n) {
+    lock_guard<mutex> guard(writer_lock);
+    struct timespec ts_start, ts_mid, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+    ApplyRoutes(updates, n);
+    Classifier *next;
+    if (incremental) {
+        for (size_t i = 0; i < n; ++i) {
+            PrefixUpdate update = updates[i];
+            if (update.withdraw) standby->Delete(&update.prefix);
+            else standby->Insert(&update.prefix);
+        }
+        next = standby;
+    } else {
+        next = Rebuild();
+    }
+
+    Classifier *old = current.exchange(next, memory_order_seq_cst);
+    clock_gettime(CLOCK_MONOTONIC, &ts_mid);
+    Synchronize();
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    last_publish_time = GetTimeInMicroSeconds(ts_start, ts_mid);
+    last_grace_time = GetTimeInMicroSeconds(ts_mid, ts_end);
+
+    if (incremental) {
+        // 旧快照已无读者, 补上同一批更新后作为下一轮的备用实例
+        for (size_t i = 0; i < n; ++i) {
+            PrefixUpdate update = updates[i];
+            if (update.withdraw) old->Delete(&update.prefix);
+            else old->Insert(&update.prefix);
+        }
+        standby = old;
+    } else {
+        delete old;
+    }
+}
+
+void RcuClassifier::Publish(Classifier *next) {
+    struct timespec ts_start, ts_end;
+    Classifier *old = current.exchange(next, memory_order_seq_cst);
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+    Synchronize();
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    last_grace_time = GetTimeInMicroSeconds(ts_start, ts_end);
+    delete old;
+
+    if (incremental) {
+        // 备用实例也要按新的流量统计重建, 否则下一次 Update 会切回旧结构
+        delete standby;
+        standby = Rebuild();
+    }
+}
+
+double RcuClassifier::ModelAccess(Classifier *classifier, const vector<TFNode> &topk) {
+    ProgramState ps;
+    double total_access = 0, total_count = 0;
+    for (auto &tf : topk) {
+        Trace trace = stringToTrace(tf.str);
+        long long before = ps.lookup_access.count;
+        classifier->Lookup(&trace, &ps);
+        total_access += (double)(ps.lookup_access.count - before) * tf.count;
+        total_count += tf.count;
+    }
+    return total_count > 0 ? total_access / total_count : 0;
+}
+
+bool RcuClassifier::Reoptimize(const vector<TFNode> &topk, double threshold) {
+    lock_guard<mutex> guard(writer_lock);
+    if (topk.empty()) return false;
+
+    struct timespec ts_start, ts_end;
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+    vector<TopKItem> saved_stats = TSL::TopKStats;
+    vector<double> saved_sum = TSL::TopKPrefixSum;
+    TSL::InitTopKStats(topk);
+    Classifier *candidate = Rebuild();
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    last_publish_time = GetTimeInMicroSeconds(ts_start, ts_end);
+
+    last_current_access = ModelAccess(current.load(), topk);
+    last_candidate_access = ModelAccess(candidate, topk);
+    if (last_candidate_access < last_current_access * (1 - threshold)) {
+        Publish(candidate);
+        return true;
+    }
+
+    delete candidate;
+    TSL::TopKStats = saved_stats;
+    TSL::TopKPrefixSum = saved_sum;
+    return false;
+}
+
+uint64_t RcuClassifier::CalMemory() {
+    uint64_t total_mem = current.load()->CalMemory();
+    if (standby) total_mem += standby->CalMemory();
+    return total_mem;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef RCU_CLASSIFIER_H
+#define RCU_CLASSIFIER_H
+
+#include "../../Elements/Elements.h"
+#include "../../Tools/Tools.h"
+#include "../Classifier.h"
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <tuple>
+
+using namespace std;
+
+#define RCU_MAX_READERS   128
+#define RCU_UPDATE_BATCH  1000
+
+// 读者在 ReadLock/ReadUnlock 之间无锁访问当前快照; 写者构造新快照后原子发布,
+// 等待所有可能持有旧快照的读者离开 (宽限期) 后再回收或复用旧快照
+class RcuClassifier {
+public:
+    RcuClassifier(function<Classifier*()> factory, vector<Prefix*> &prefixs, bool incremental);
+    ~RcuClassifier();
+
+    int RegisterReader();
+    void ReadLock(int reader);
+    void ReadUnlock(int reader);
+    uint32_t Lookup(int reader, Trace *trace);
+    void LookupBatch(int reader, const Trace *traces, size_t n, uint32_t *out);
+
+    void Update(const PrefixUpdate *updates, size_t n);
+    // 用新的 TopK 流量快照重建; 建模的平均访存次数下降超过 threshold (比例) 才发布, 否则丢弃
+    bool Reoptimize(const vector<TFNode> &topk, double threshold);
+    uint64_t CalMemory();
+
+    double last_publish_time;   // US, 从开始构造到新快照发布
+    double last_grace_time;     // US, 等待宽限期
+    double last_current_access;     // 当前快照在 TopK 流量上的加权平均访存次数
+    double last_candidate_access;   // 重建结果在 TopK 流量上的加权平均访存次数
+
+private:
+    struct alignas(64) ReaderSlot {
+        atomic<uint64_t> epoch;     // 0 表示读者处于静止状态
+    };
+
+    function<Classifier*()> factory;
+    bool incremental;               // 支持 Insert/Delete 时采用双实例, 否则每批整体重建
+    atomic<Classifier*> current;
+    Classifier* standby;
+    alignas(64) atomic<uint64_t> global_epoch;
+    atomic<int> reader_num;
+    ReaderSlot slots[RCU_MAX_READERS];
+
+    map<tuple<uint64_t, uint64_t, uint8_t>, uint32_t> routes;
+    ProgramState build_ps;
+    mutex writer_lock;              // Update / Reoptimize 互斥, 同时保护构建时使用的 TSL
+
+    void ApplyRoutes(const PrefixUpdate *updates, size_t n);
+    Classifier* Rebuild();
+    void Synchronize();
+    void Publish(Classifier *next);
+    double ModelAccess(Classifier *classifier, const vector<TFNode> &topk);
+};
+
+#endif
\ No newline at end of file
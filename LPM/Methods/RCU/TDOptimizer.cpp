@@ -0,0 +1,54 @@
+#include "TDOptimizer.h"
+
+TDOptimizer::TDOptimizer(RcuClassifier *rcu, double threshold)
+    : rcu(rcu), threshold(threshold), has_pending(false), stopping(false) {
+    rounds = swaps = 0;
+    total_build_time = 0;
+    last_current_access = last_candidate_access = 0;
+}
+
+TDOptimizer::~TDOptimizer() {
+    Stop();
+}
+
+void TDOptimizer::Start() {
+    worker = thread(&TDOptimizer::Run, this);
+}
+
+void TDOptimizer::Offer(vector<TFNode> topk) {
+    {
+        lock_guard<mutex> guard(lock);
+        pending = move(topk);   // 只保留最新的快照
+        has_pending = true;
+    }
+    cv.notify_one();
+}
+
+void TDOptimizer::Stop() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    cv.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void TDOptimizer::Run() {
+    while (true) {
+        vector<TFNode> topk;
+        {
+            unique_lock<mutex> guard(lock);
+            cv.wait(guard, [this]() { return has_pending || stopping; });
+            if (!has_pending) return;
+            topk = move(pending);
+            has_pending = false;
+        }
+
+        bool swapped = rcu->Reoptimize(topk, threshold);
+        rounds++;
+        if (swapped) swaps++;
+        total_build_time += rcu->last_publish_time;
+        last_current_access = rcu->last_current_access;
+        last_candidate_access = rcu->last_candidate_access;
+    }
+}
\ No newline at end of file
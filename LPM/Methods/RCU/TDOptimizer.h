@@ -0,0 +1,41 @@
+#ifndef TD_OPTIMIZER_H
+#define TD_OPTIMIZER_H
+
+#include "RcuClassifier.h"
+#include <condition_variable>
+
+using namespace std;
+
+#define TD_OPTIMIZER_THRESHOLD 0.05
+
+// 后台优化线程: 数据面线程定期 Offer 自己 sketch 的 TopK 快照 (不共享 sketch, 不加锁),
+// 优化线程取最新快照在快路径之外重建 TD 结构, 通过 RcuClassifier::Reoptimize 按阈值决定是否发布
+class TDOptimizer {
+public:
+    TDOptimizer(RcuClassifier *rcu, double threshold);
+    ~TDOptimizer();
+
+    void Start();
+    void Offer(vector<TFNode> topk);
+    void Stop();        // 处理完已提交的快照后退出
+
+    int rounds;
+    int swaps;
+    double total_build_time;        // US
+    double last_current_access;
+    double last_candidate_access;
+
+private:
+    RcuClassifier *rcu;
+    double threshold;
+    thread worker;
+    mutex lock;
+    condition_variable cv;
+    vector<TFNode> pending;
+    bool has_pending;
+    bool stopping;
+
+    void Run();
+};
+
+#endif
\ No newline at end of file
@@ -3,5 +3,8 @@
 
 #include "io.h"
 #include "transition.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "latency.h"
 
 #endif
\ No newline at end of file
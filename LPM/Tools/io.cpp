@@ -1,4 +1,8 @@
 #include "io.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <omp.h>
 
 using namespace std;
 
@@ -19,40 +23,130 @@ bool ipv6_str_to_uint128(const string &ip6_str, uint64_t &upper, uint64_t &lower
     return true;
 }
 
+static const int8_t HEX_VALUE[256] = {
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
+
+// 手写 IPv6 文本解析 (支持 "::" 压缩), 不认识的写法 (如内嵌 IPv4) 交给 inet_pton
+bool ParseIPv6(const char *begin, const char *end, uint64_t &upper, uint64_t &lower) {
+    uint16_t groups[8];
+    int n = 0, gap = -1;
+    const char *p = begin;
+
+    if (p < end && *p == ':') {
+        if (p + 1 >= end || p[1] != ':') return false;
+        gap = 0;
+        p += 2;
+    }
+    while (p < end && n < 8) {
+        uint32_t value = 0;
+        int digits = 0;
+        for (; p < end && digits < 5; ++p, ++digits) {
+            int h = HEX_VALUE[(uint8_t)*p];
+            if (h < 0) break;
+            value = (value << 4) | h;
+        }
+        if (digits == 0 || digits > 4) break;
+        groups[n++] = value;
+        if (p == end) break;
+        if (*p != ':' || ++p == end) { n = -1; break; }
+        if (*p == ':') {
+            if (gap >= 0) { n = -1; break; }
+            gap = n;
+            ++p;
+        }
+    }
+
+    if (p != end || n < 0 || (gap < 0 ? n != 8 : n == 8)) {
+        char buf[INET6_ADDRSTRLEN];
+        if (end - begin >= (long)sizeof(buf)) return false;
+        memcpy(buf, begin, end - begin);
+        buf[end - begin] = 0;
+        return ipv6_str_to_uint128(buf, upper, lower);
+    }
+
+    uint64_t words[8] = {0};
+    for (int i = 0; i < n; ++i) {
+        words[gap >= 0 && i >= gap ? i + 8 - n : i] = groups[i];
+    }
+    upper = (words[0] << 48) | (words[1] << 32) | (words[2] << 16) | words[3];
+    lower = (words[4] << 48) | (words[5] << 32) | (words[6] << 16) | words[7];
+    return true;
+}
+
+// 只读映射整个文件, 打不开或为空时返回 NULL
+static const char* map_file(const string &path, size_t &size) {
+    size = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    size = st.st_size;
+    return (const char*)data;
+}
+
+// 去掉行尾的 '\r' 与空白
+static inline const char* trim_line(const char *begin, const char *end) {
+    while (end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) --end;
+    return end;
+}
+
 vector<Prefix*> ReadPrefixs(string prefixs_file) {
     vector<Prefix*> prefixs;
-    ifstream file(prefixs_file);
-    string line;
-    
-    if (!file.is_open()) {
+    size_t size;
+    const char *data = map_file(prefixs_file, size);
+    if (data == NULL) {
         cerr << "Error opening prefix file: " << prefixs_file << endl;
         return prefixs;
     }
-    
+
     int port_id = 1;
-    while (getline(file, line)) {
-        if (line.empty() || line[0] == '#') {
+    const char *file_end = data + size;
+    for (const char *line = data; line < file_end; ) {
+        const char *newline = (const char*)memchr(line, '\n', file_end - line);
+        const char *next = newline ? newline + 1 : file_end;
+        const char *end = trim_line(line, newline ? newline : file_end);
+        if (end == line || *line == '#') {
+            line = next;
             continue;
         }
-        
-        size_t slash_pos = line.find('/');
-        if (slash_pos == string::npos) {
-            cerr << "Invalid prefix format: " << line << endl;
+
+        const char *slash = (const char*)memchr(line, '/', end - line);
+        if (slash == NULL) {
+            cerr << "Invalid prefix format: " << string(line, end) << endl;
+            line = next;
             continue;
         }
-        
-        string ip_str = line.substr(0, slash_pos);
-        string len_str = line.substr(slash_pos + 1);
-        
+
         uint64_t upper, lower;
-        if (!ipv6_str_to_uint128(ip_str, upper, lower)) {
-            cerr << "Invalid IPv6 address: " << ip_str << endl;
+        if (!ParseIPv6(line, slash, upper, lower)) {
+            cerr << "Invalid IPv6 address: " << string(line, slash) << endl;
+            line = next;
             continue;
         }
-        
-        int prefix_len = stoi(len_str);
-        if (prefix_len < 0 || prefix_len > 128) {
-            cerr << "Invalid prefix length: " << prefix_len << endl;
+
+        int prefix_len = 0;
+        const char *p = slash + 1;
+        for (; p < end && *p >= '0' && *p <= '9' && prefix_len <= 128; ++p) {
+            prefix_len = prefix_len * 10 + (*p - '0');
+        }
+        if (p == slash + 1 || p != end || prefix_len > 128) {
+            cerr << "Invalid prefix length: " << string(slash + 1, end) << endl;
+            line = next;
             continue;
         }
     
@@ -64,9 +158,10 @@ vector<Prefix*> ReadPrefixs(string prefixs_file) {
         
         prefixs.push_back(prefix);
         port_id++;
+        line = next;
     }
     
-    file.close();
+    munmap((void*)data, size);
     return prefixs;
 }
 
@@ -79,36 +174,153 @@ void PrintPrefixHex(const Prefix* prefix) {
     printf("Port: %u\n", prefix->port);
 }
 
-vector<Trace*> ReadTraces(string traces_file) {
-    vector<Trace*> traces;
-    ifstream file(traces_file);
-    string line;
-    
-    if (!file.is_open()) {
+// 文本 trace 按行边界切成若干块并行解析: 先数每块行数定好写入位置, 再各自解析, 最后压掉无效行留下的空位
+vector<Trace> LoadTraces(string traces_file) {
+    vector<Trace> traces;
+    size_t size;
+    const char *data = map_file(traces_file, size);
+    if (data == NULL) {
         cerr << "Error opening traces file: " << traces_file << endl;
         return traces;
     }
-    
+
+    const TraceFileHeader *header = (const TraceFileHeader*)data;
+    if (size >= sizeof(TraceFileHeader) && memcmp(header->magic, TRACE_BINARY_MAGIC, sizeof(header->magic)) == 0) {
+        if (size != sizeof(TraceFileHeader) + header->count * sizeof(Trace)) {
+            cerr << "Truncated binary traces file: " << traces_file << endl;
+        } else {
+            const Trace *records = (const Trace*)(data + sizeof(TraceFileHeader));
+            traces.assign(records, records + header->count);
+        }
+        munmap((void*)data, size);
+        return traces;
+    }
+
+    int chunks = max(1, omp_get_max_threads());
+    vector<size_t> start(chunks + 1, size);
+    start[0] = 0;
+    for (int c = 1; c < chunks; ++c) {
+        size_t pos = max(size * c / chunks, start[c - 1]);
+        const char *newline = (const char*)memchr(data + pos, '\n', size - pos);
+        start[c] = newline ? newline - data + 1 : size;
+    }
+
+    vector<size_t> base(chunks + 1, 0), parsed(chunks, 0);
+    #pragma omp parallel for schedule(static, 1)
+    for (int c = 0; c < chunks; ++c) {
+        size_t lines = 0;
+        for (const char *p = data + start[c], *end = data + start[c + 1]; p < end; ++lines) {
+            const char *newline = (const char*)memchr(p, '\n', end - p);
+            p = newline ? newline + 1 : end;
+        }
+        base[c + 1] = lines;
+    }
+    for (int c = 0; c < chunks; ++c) {
+        base[c + 1] += base[c];
+    }
+    traces.resize(base[chunks]);
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int c = 0; c < chunks; ++c) {
+        Trace *out = traces.data() + base[c];
+        const char *chunk_end = data + start[c + 1];
+        for (const char *line = data + start[c]; line < chunk_end; ) {
+            const char *newline = (const char*)memchr(line, '\n', chunk_end - line);
+            const char *next = newline ? newline + 1 : chunk_end;
+            const char *end = trim_line(line, newline ? newline : chunk_end);
+            if (end != line && *line != '#') {
+                if (ParseIPv6(line, end, out->ip6_upper, out->ip6_lower)) {
+                    ++out;
+                } else {
+                    #pragma omp critical
+                    cerr << "Invalid IPv6 address: " << string(line, end) << endl;
+                }
+            }
+            line = next;
+        }
+        parsed[c] = out - (traces.data() + base[c]);
+    }
+
+    size_t count = parsed[0];
+    for (int c = 1; c < chunks; ++c) {
+        memmove(traces.data() + count, traces.data() + base[c], parsed[c] * sizeof(Trace));
+        count += parsed[c];
+    }
+    traces.resize(count);
+    munmap((void*)data, size);
+    return traces;
+}
+
+bool SaveTracesBinary(const vector<Trace> &traces, string traces_file) {
+    ofstream file(traces_file, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error opening traces file: " << traces_file << endl;
+        return false;
+    }
+
+    TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_BINARY_MAGIC, sizeof(header.magic));
+    header.count = traces.size();
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)traces.data(), traces.size() * sizeof(Trace));
+    return (bool)file;
+}
+
+vector<PrefixUpdate> ReadUpdates(string update_file) {
+    vector<PrefixUpdate> updates;
+    ifstream file(update_file);
+    string line;
+
+    if (!file.is_open()) {
+        cerr << "Error opening update file: " << update_file << endl;
+        return updates;
+    }
+
     while (getline(file, line)) {
         if (line.empty() || line[0] == '#') {
             continue;
         }
-        
+
+        istringstream iss(line);
+        string type, prefix_str;
+        uint32_t port = 0;
+        iss >> type >> prefix_str;
+        if ((type != "A" && type != "W") || (type == "A" && !(iss >> port))) {
+            cerr << "Invalid update format: " << line << endl;
+            continue;
+        }
+
+        size_t slash_pos = prefix_str.find('/');
+        if (slash_pos == string::npos) {
+            cerr << "Invalid prefix format: " << line << endl;
+            continue;
+        }
+
+        string ip_str = prefix_str.substr(0, slash_pos);
         uint64_t upper, lower;
-        if (!ipv6_str_to_uint128(line, upper, lower)) {
-            cerr << "Invalid IPv6 address: " << line << endl;
+        if (!ipv6_str_to_uint128(ip_str, upper, lower)) {
+            cerr << "Invalid IPv6 address: " << ip_str << endl;
             continue;
         }
-        
-        Trace* trace = new Trace();
-        trace->ip6_upper = upper;
-        trace->ip6_lower = lower;
-        
-        traces.push_back(trace);
+
+        int prefix_len = stoi(prefix_str.substr(slash_pos + 1));
+        if (prefix_len < 0 || prefix_len > 128) {
+            cerr << "Invalid prefix length: " << prefix_len << endl;
+            continue;
+        }
+
+        PrefixUpdate update;
+        update.withdraw = (type == "W");
+        update.prefix.ip6_upper = upper;
+        update.prefix.ip6_lower = lower;
+        update.prefix.prefix_len = static_cast<uint8_t>(prefix_len);
+        update.prefix.port = port;
+        updates.push_back(update);
     }
-    
+
     file.close();
-    return traces;
+    return updates;
 }
 
 vector<uint32_t> ReadLinearAns(string ans_file) {
@@ -9,7 +9,19 @@ using namespace std;
 vector<Prefix*> ReadPrefixs(string prefixs_file);
 void PrintPrefixHex(const Prefix* prefix);
 
-vector<Trace*> ReadTraces(string traces_file);
+// 二进制 trace 文件: TraceFileHeader 后紧跟 count 个 Trace
+#define TRACE_BINARY_MAGIC "TLFTRC1"
+
+typedef struct TraceFileHeader {
+    char     magic[8];
+    uint64_t count;
+} TraceFileHeader;
+
+bool ParseIPv6(const char *begin, const char *end, uint64_t &upper, uint64_t &lower);
+vector<Trace> LoadTraces(string traces_file);
+bool SaveTracesBinary(const vector<Trace> &traces, string traces_file);
+
+vector<PrefixUpdate> ReadUpdates(string update_file);
 
 vector<uint32_t> ReadLinearAns(string ans_file);
 void SaveLinearAns(vector<uint32_t> &ans, string ans_file);
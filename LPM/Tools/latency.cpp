@@ -0,0 +1,57 @@
+#include "latency.h"
+
+using namespace std;
+
+LatencyHistogram::LatencyHistogram() {
+    buckets.assign(LATENCY_BUCKETS, 0);
+    count = max_value = 0;
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    buckets[BucketIndex(value)]++;
+    count++;
+    max_value = max(max_value, value);
+}
+
+void LatencyHistogram::Clear() {
+    fill(buckets.begin(), buckets.end(), 0);
+    count = max_value = 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+    if (count == 0) return 0;
+    uint64_t target = (uint64_t)ceil(p / 100.0 * count);
+    target = min(max(target, (uint64_t)1), count);
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= target) return min(BucketUpper(i), max_value);
+    }
+    return max_value;
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < LATENCY_SUB_BUCKETS) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int group = msb - LATENCY_SUB_BITS + 1;
+    int sub = (int)(value >> (msb - LATENCY_SUB_BITS)) - LATENCY_SUB_BUCKETS;
+    return group * LATENCY_SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpper(int index) {
+    int group = index / LATENCY_SUB_BUCKETS;
+    int sub = index % LATENCY_SUB_BUCKETS;
+    if (group == 0) return sub;
+    uint64_t width = 1ULL << (group - 1);
+    return ((uint64_t)(LATENCY_SUB_BUCKETS + sub) << (group - 1)) + width - 1;
+}
+
+uint64_t CalibrateLatencyOverhead(int rounds) {
+    uint64_t overhead = UINT64_MAX;
+    for (int i = 0; i < rounds; ++i) {
+        uint64_t start = LatencyStart();
+        uint64_t stop = LatencyStop();
+        overhead = min(overhead, stop - start);
+    }
+    return overhead;
+}
\ No newline at end of file
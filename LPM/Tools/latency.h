@@ -0,0 +1,52 @@
+#ifndef  LATENCY_H
+#define  LATENCY_H
+
+#include "../Elements/Elements.h"
+#include <x86intrin.h>
+
+using namespace std;
+
+// 对数线性 (HDR 风格) 直方图: 小于 2^LATENCY_SUB_BITS 的值精确计数,
+// 更大的值按 2 的幂分组, 每组再等分 2^LATENCY_SUB_BITS 个桶, 相对误差不超过 1/32
+#define LATENCY_SUB_BITS    5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS     ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    void Record(uint64_t value);
+    void Clear();
+    uint64_t Count() const { return count; }
+    uint64_t Max() const { return max_value; }
+    // 第 p 百分位 (0 < p <= 100) 所在桶的上界
+    uint64_t Percentile(double p) const;
+
+private:
+    vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t max_value;
+
+    static int BucketIndex(uint64_t value);
+    static uint64_t BucketUpper(int index);
+};
+
+// rdtsc 计时: lfence 保证被测代码不会越过两端的时间戳
+static inline uint64_t LatencyStart() {
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+static inline uint64_t LatencyStop() {
+    unsigned int aux;
+    uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+
+// 空测量 (Start 紧接 Stop) 的最小周期数, 作为每个样本要扣除的固定开销
+uint64_t CalibrateLatencyOverhead(int rounds);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "snapshot.h"
+
+using namespace std;
+
+SnapshotWriter::SnapshotWriter() {
+    memset(params, 0, sizeof(params));
+    Append(NULL, sizeof(SnapshotHeader));
+}
+
+uint64_t SnapshotWriter::Append(const void *data, size_t size) {
+    uint64_t offset = (image.size() + SNAPSHOT_ALIGN - 1) & ~(uint64_t)(SNAPSHOT_ALIGN - 1);
+    image.resize(offset + size, 0);
+    if (data != NULL && size > 0) {
+        memcpy(image.data() + offset, data, size);
+    }
+    return offset;
+}
+
+void SnapshotWriter::SetPointer(uint64_t field, uint64_t target) {
+    *At<uint64_t>(field) = target;
+    relocs.push_back(field);
+}
+
+bool SnapshotWriter::Write(const string &path, const string &method) {
+    if (method.size() >= sizeof(((SnapshotHeader*)0)->method)) {
+        cout << "SnapshotWriter::Write() : method name too long " << method << endl;
+        return false;
+    }
+    uint64_t reloc_offset = Append(relocs.data(), relocs.size() * sizeof(uint64_t));
+
+    SnapshotHeader *header = At<SnapshotHeader>(0);
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    strcpy(header->method, method.c_str());
+    header->image_size = image.size();
+    header->reloc_offset = reloc_offset;
+    header->reloc_count = relocs.size();
+    memcpy(header->params, params, sizeof(params));
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        cout << "SnapshotWriter::Write() : can not open " << path << endl;
+        return false;
+    }
+    out.write(image.data(), image.size());
+    return (bool)out;
+}
+
+SnapshotImage::SnapshotImage() {
+    base = NULL;
+    size = 0;
+}
+
+SnapshotImage::~SnapshotImage() {
+    if (base != NULL) munmap(base, size);
+}
+
+bool SnapshotImage::Open(const string &path, const string &method) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    SnapshotHeader header;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.image_size != (uint64_t)st.st_size) {
+        cout << "SnapshotImage::Open() : " << path << " is not a snapshot" << endl;
+        close(fd);
+        return false;
+    }
+    if (strncmp(header.method, method.c_str(), sizeof(header.method)) != 0) {
+        cout << "SnapshotImage::Open() : " << path << " was saved by " << header.method << ", not " << method << endl;
+        close(fd);
+        return false;
+    }
+
+    this->path = path;
+    // 无指针的镜像以只读共享方式映射, 多个进程共用同一份物理页
+    size = header.image_size;
+    if (header.reloc_count == 0) {
+        base = (char*)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    } else {
+        base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        cout << "SnapshotImage::Open() : mmap " << path << " fail" << endl;
+        base = NULL;
+        size = 0;
+        return false;
+    }
+
+    // 重定位表及其指向的字段都必须落在镜像内, 否则损坏的文件会越界写私有映射
+    if (header.reloc_count > 0) {
+        if (header.reloc_offset % sizeof(uint64_t) != 0 || header.reloc_offset > size ||
+            header.reloc_count > (size - header.reloc_offset) / sizeof(uint64_t)) {
+            return Fail();
+        }
+        const uint64_t *relocs = (const uint64_t*)(base + header.reloc_offset);
+        for (uint64_t i = 0; i < header.reloc_count; ++i) {
+            if (relocs[i] % sizeof(uint64_t) != 0 || relocs[i] < sizeof(SnapshotHeader) ||
+                relocs[i] > size - sizeof(uint64_t)) {
+                return Fail();
+            }
+            uint64_t *field = (uint64_t*)(base + relocs[i]);
+            if (*field >= size) return Fail();
+            *field = *field ? (uint64_t)(base + *field) : 0;
+        }
+        mprotect(base, size, PROT_READ);
+    }
+    return true;
+}
+
+bool SnapshotImage::CheckParam(int i, uint64_t count, uint64_t elem_size) const {
+    uint64_t offset = Param(i);
+    if (offset < sizeof(SnapshotHeader) || offset > size ||
+        (elem_size != 0 && count > (size - offset) / elem_size)) {
+        cout << "SnapshotImage::Open() : " << path << " is not a snapshot" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotImage::Fail() {
+    cout << "SnapshotImage::Open() : " << path << " is not a snapshot" << endl;
+    munmap(base, size);
+    base = NULL;
+    size = 0;
+    return false;
+}
\ No newline at end of file
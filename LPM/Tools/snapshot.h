@@ -0,0 +1,63 @@
+#ifndef  SNAPSHOT_H
+#define  SNAPSHOT_H
+
+#include "../Elements/Elements.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+using namespace std;
+
+#define SNAPSHOT_MAGIC   "TLFSNAP1"
+#define SNAPSHOT_ALIGN   64
+#define SNAPSHOT_PARAMS  16
+
+// 快照文件头 (位于偏移 0): 镜像内的指针一律存为相对文件起点的偏移 (0 表示空指针)
+// reloc 区记录所有指针字段的位置; 没有指针字段的镜像可以只读共享映射后直接使用
+typedef struct SnapshotHeader {
+    char     magic[8];
+    char     method[24];
+    uint64_t image_size;
+    uint64_t reloc_offset;
+    uint64_t reloc_count;
+    uint64_t params[SNAPSHOT_PARAMS];
+} SnapshotHeader;
+
+class SnapshotWriter {
+public:
+    uint64_t params[SNAPSHOT_PARAMS];
+
+    SnapshotWriter();
+    // 追加一块 SNAPSHOT_ALIGN 对齐的数据 (data 为空时填 0), 返回其偏移; 追加后之前 At() 得到的地址失效
+    uint64_t Append(const void *data, size_t size);
+    template<typename T> T* At(uint64_t offset) { return (T*)(image.data() + offset); }
+    // 把 field 处的指针字段写成 target 偏移, 并登记重定位
+    void SetPointer(uint64_t field, uint64_t target);
+    bool Write(const string &path, const string &method);
+
+private:
+    vector<char> image;
+    vector<uint64_t> relocs;
+};
+
+class SnapshotImage {
+public:
+    SnapshotImage();
+    ~SnapshotImage();
+    // 校验 magic / method 后映射整个文件; 有重定位时私有映射并把偏移改回指针
+    bool Open(const string &path, const string &method);
+    template<typename T> T* At(uint64_t offset) const { return offset ? (T*)(base + offset) : NULL; }
+    uint64_t Param(int i) const { return ((const SnapshotHeader*)base)->params[i]; }
+    // params[i] 作为偏移时, 校验其后 count 个 elem_size 字节的元素都落在镜像内
+    bool CheckParam(int i, uint64_t count, uint64_t elem_size) const;
+    size_t Size() const { return size; }
+
+private:
+    char  *base;
+    size_t size;
+    string path;
+
+    bool Fail();
+};
+
+#endif
\ No newline at end of file
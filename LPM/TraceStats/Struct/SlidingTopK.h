@@ -0,0 +1,84 @@
+#ifndef SLIDING_TOPK_H
+#define SLIDING_TOPK_H
+
+#include "../../Elements/Elements.h"
+#include "TDHeavyKeeper.h"
+
+constexpr uint32_t SLIDING_TOPK_EPOCHS = 4;
+constexpr double SLIDING_TOPK_DRIFT_THRESHOLD = 0.3;   // 超过该漂移量认为值得按当前流量重建
+
+// 滑动窗口 TopK: 窗口分成 epochs 个 epoch, 每个 epoch 一个 TDHeavyKeeper.
+// 按包数滑动时每 window / epochs 个包自动切换 epoch; 按时间滑动时由调用者定时调用 rotate().
+// work() 合并所有 epoch 的 sketch, 得到最近一个窗口 (epoch 粒度) 的 TopK.
+class SlidingTopK {
+public:
+    SlidingTopK(uint32_t topK, uint32_t maxMem, uint64_t window, uint32_t epochs)
+        : k_(topK), maxMem_(maxMem), epochs_(std::max(epochs, 1U)), current_(0), epochCount_(0) {
+        epochSize_ = window > 0 ? std::max<uint64_t>(window / epochs_, 1) : 0;
+        for (uint32_t i = 0; i < epochs_; ++i) {
+            sketches_.push_back(new TDHeavyKeeper(topK, maxMem, i + 1));
+        }
+    }
+
+    ~SlidingTopK() {
+        for (auto sketch : sketches_) delete sketch;
+        sketches_.clear();
+    }
+
+    void insert(__uint128_t key) {
+        if (epochSize_ > 0 && epochCount_ >= epochSize_) rotate();
+        sketches_[current_]->insert(key);
+        epochCount_++;
+    }
+
+    // 丢弃最老的 epoch, 开始新的 epoch
+    void rotate() {
+        current_ = (current_ + 1) % epochs_;
+        sketches_[current_]->clear();
+        epochCount_ = 0;
+    }
+
+    std::vector<TFNode> work() const {
+        TDHeavyKeeper window(k_, maxMem_);
+        for (auto sketch : sketches_) {
+            window.merge(*sketch);
+        }
+        return window.work();
+    }
+
+    uint64_t calculateMemory() const {
+        uint64_t totalMemory = sizeof(*this);
+        for (auto sketch : sketches_) {
+            totalMemory += sketch->calculateMemory();
+        }
+        return totalMemory;
+    }
+
+    // 两个 TopK 频率分布 (各自归一化) 的总变差距离, 0 表示热点不变, 1 表示完全不重合.
+    // base 为上次按流量构建时使用的 TopK, current 为当前窗口的 TopK
+    static double drift(const std::vector<TFNode>& base, const std::vector<TFNode>& current) {
+        double baseTotal = 0, currentTotal = 0;
+        for (const auto& tf : base) baseTotal += tf.count;
+        for (const auto& tf : current) currentTotal += tf.count;
+        if (baseTotal == 0 || currentTotal == 0) return (baseTotal == currentTotal) ? 0.0 : 1.0;
+
+        std::unordered_map<std::string, double> diff;
+        for (const auto& tf : base) diff[tf.str] += tf.count / baseTotal;
+        for (const auto& tf : current) diff[tf.str] -= tf.count / currentTotal;
+
+        double distance = 0;
+        for (const auto& it : diff) distance += std::fabs(it.second);
+        return distance / 2;
+    }
+
+private:
+    uint32_t k_;
+    uint32_t maxMem_;
+    uint32_t epochs_;
+    uint32_t current_;
+    uint64_t epochSize_;
+    uint64_t epochCount_;
+    std::vector<TDHeavyKeeper*> sketches_;
+};
+
+#endif  // SLIDING_TOPK_H
\ No newline at end of file
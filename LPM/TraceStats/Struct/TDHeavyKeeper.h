@@ -9,14 +9,15 @@ constexpr uint32_t HK_ROWS = 2;
 constexpr double HK_DECAY_FACTOR = 1.08;   
 constexpr uint32_t HK_EXTRA_SIZE = 10;     
 constexpr uint32_t HK_FP_SHIFT = 56;     
+constexpr uint32_t HK_DECAY_TABLE_SIZE = 512;   // 更大的计数衰减概率按 0 处理
 
 class TDHeavyKeeper {
 public:
     TDHeavyKeeper() 
-        : ss_(nullptr), hkTable_(nullptr), bobhash_(nullptr), k_(0), maxMem_(0) {}
+        : ss_(nullptr), hkTable_(nullptr), bobhash_(nullptr), k_(0), maxMem_(0), rng_(seedRng(1)) {}
 
-    TDHeavyKeeper(uint32_t topK, uint32_t maxMem) 
-        : k_(topK), maxMem_(maxMem), ss_(nullptr), hkTable_(nullptr), bobhash_(nullptr) {
+    TDHeavyKeeper(uint32_t topK, uint32_t maxMem, uint32_t seed = 1) 
+        : k_(topK), maxMem_(maxMem), ss_(nullptr), hkTable_(nullptr), bobhash_(nullptr), rng_(seedRng(seed)) {
         ss_ = new TDSSummary(topK);
 
         hkTable_ = new HKNode*[HK_ROWS];
@@ -56,11 +57,21 @@ public:
     }
 
     void insert(const std::string& flowStr) {
+        assert(flowStr.size() == 16);
+        __uint128_t key = 0;
+        for (int i = 0; i < 16; ++i) {
+            key = (key << 8) | static_cast<uint8_t>(flowStr[i]);
+        }
+        insert(key);
+    }
+
+    // 定长 key (ip6_upper << 64 | ip6_lower), 不分配内存; 哈希值与对应的 16 字节字符串一致
+    void insert(__uint128_t key) {
         uint32_t maxCount = 0;
-        const uint64_t hashValue = hashString(flowStr);  
+        const uint64_t hashValue = hashKey(key);  
         const uint32_t fingerprint = static_cast<uint32_t>(hashValue >> HK_FP_SHIFT); 
 
-        const uint32_t ssNodeId = ss_->findId(flowStr, hashValue);
+        const uint32_t ssNodeId = ss_->findId(key, hashValue);
         const bool isInSummary = (ssNodeId != 0);
 
         for (uint32_t row = 0; row < HK_ROWS; ++row) {
@@ -74,13 +85,8 @@ public:
                 }
                 maxCount = std::max(maxCount, currentNode.C);
             } else {
-                const int decayProbInt = std::pow(HK_DECAY_FACTOR, currentCount);
-                if (decayProbInt <= 0) {
-                    std::cerr << "TDHeavyKeeper: factor=" << HK_DECAY_FACTOR << ", count=" << currentCount << std::endl;
-                    std::exit(1);
-                }
-
-                if (std::rand() % decayProbInt == 0) {
+                const uint64_t threshold = currentCount < HK_DECAY_TABLE_SIZE ? decayThresholds()[currentCount] : 0;
+                if (nextRandom() < threshold) {
                     if (currentNode.C > 0) {
                         currentNode.C--;
                     }
@@ -100,7 +106,7 @@ public:
         if (!isInSummary) {
             if ((ss_->total_count_ < k_) || (logMaxCount - ss_->getMinCount() == 1)) {
                 // cout<<ss_->total_count_<<" "<<k_<<endl;
-                ss_->createNode(flowStr, hashValue, logMaxCount, maxCount);
+                ss_->createNode(key, hashValue, logMaxCount, maxCount);
             }
         } else if (maxCount > ss_->flow_nodes_[ssNodeId].Count){
             ss_->updateNodeCounts(ssNodeId, logMaxCount, maxCount);
@@ -114,7 +120,7 @@ public:
         for (uint32_t count = TD_MAX_FLOW_NUM; count != 0 ; count--) {
             for (uint32_t nodeId = ss_->head_nodes_[count].id; nodeId != 0; nodeId = ss_->flow_nodes_[nodeId].nxt) {
                 result.emplace_back(
-                    ss_->flow_nodes_[nodeId].str, 
+                    keyToString(ss_->flow_nodes_[nodeId].key), 
                     ss_->flow_nodes_[nodeId].Count
                 );
             }
@@ -124,6 +130,52 @@ public:
         return result;
     }
 
+    // 合并另一个 (相同 topK / maxMem 的) sketch: 同指纹计数相加, 否则保留较大者并减去较小者;
+    // TopK 按流汇总计数后重建. other 不会被修改, 可以周期性地把各核心的 sketch 合并到一个全局 sketch
+    void merge(const TDHeavyKeeper& other) {
+        assert(ss_ != nullptr && other.ss_ != nullptr);
+        if (other.maxMem_ != maxMem_) {
+            std::cerr << "TDHeavyKeeper::merge: maxMem mismatch " << maxMem_ << " != " << other.maxMem_ << std::endl;
+            std::exit(1);
+        }
+
+        for (uint32_t row = 0; row < HK_ROWS; ++row) {
+            for (uint32_t j = 0; j < maxMem_ + HK_EXTRA_SIZE; ++j) {
+                HKNode& node = hkTable_[row][j];
+                const HKNode& otherNode = other.hkTable_[row][j];
+                if (node.FP == otherNode.FP) {
+                    node.C += otherNode.C;
+                } else if (node.C >= otherNode.C) {
+                    node.C -= otherNode.C;
+                } else {
+                    node.FP = otherNode.FP;
+                    node.C = otherNode.C - node.C;
+                }
+            }
+        }
+
+        std::map<__uint128_t, uint32_t> flowCounts;
+        for (const TDHeavyKeeper* sketch : {static_cast<const TDHeavyKeeper*>(this), &other}) {
+            for (uint32_t count = TD_MAX_FLOW_NUM; count != 0 ; count--) {
+                for (uint32_t nodeId = sketch->ss_->head_nodes_[count].id; nodeId != 0; nodeId = sketch->ss_->flow_nodes_[nodeId].nxt) {
+                    flowCounts[sketch->ss_->flow_nodes_[nodeId].key] += sketch->ss_->flow_nodes_[nodeId].Count;
+                }
+            }
+        }
+
+        std::vector<std::pair<uint32_t, __uint128_t>> flows;
+        for (const auto& it : flowCounts) flows.emplace_back(it.second, it.first);
+        std::sort(flows.begin(), flows.end(), [](const std::pair<uint32_t, __uint128_t>& a, const std::pair<uint32_t, __uint128_t>& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        if (flows.size() > k_) flows.erase(flows.begin() + k_, flows.end());
+
+        ss_->clear();
+        for (auto it = flows.rbegin(); it != flows.rend(); ++it) {
+            ss_->createNode(it->second, hashKey(it->second), log2(std::max(it->first, 1U)), it->first);
+        }
+    }
+
     uint64_t calculateMemory() const {
         uint64_t totalMemory = 0;
 
@@ -164,7 +216,8 @@ public:
                       << ", Right: " << ss_->head_nodes_[count].right << std::endl;
             
             for (uint32_t nodeId = ss_->head_nodes_[count].id; nodeId != 0; nodeId = ss_->flow_nodes_[nodeId].nxt) {
-                std::cout << "Flow: " << ss_->flow_nodes_[nodeId].str
+                std::cout << "Flow: " << std::hex << (uint64_t)(ss_->flow_nodes_[nodeId].key >> 64) 
+                          << ":" << (uint64_t)ss_->flow_nodes_[nodeId].key << std::dec
                           << ", Log Count: " << ss_->flow_nodes_[nodeId].logCount
                           << ", Original Count: " << ss_->flow_nodes_[nodeId].Count << std::endl;
             }
@@ -178,8 +231,52 @@ private:
         uint32_t FP;  
     };
 
-    uint64_t hashString(const std::string& flowStr) const {
-        return bobhash_->run(flowStr.c_str(), flowStr.size());
+    uint64_t hashKey(__uint128_t key) const {
+        char bytes[16];
+        for (int i = 15; i >= 0; --i) {
+            bytes[i] = static_cast<char>(key & 0xFF);
+            key >>= 8;
+        }
+        return bobhash_->run(bytes, 16);
+    }
+
+    static std::string keyToString(__uint128_t key) {
+        std::string str(16, '\0');
+        for (int i = 15; i >= 0; --i) {
+            str[i] = static_cast<char>(key & 0xFF);
+            key >>= 8;
+        }
+        return str;
+    }
+
+    // decayThresholds()[c] = 2^32 / floor(HK_DECAY_FACTOR^c), 32 位随机数小于它的概率即衰减概率
+    static const uint64_t* decayThresholds() {
+        static const std::vector<uint64_t> table = []() {
+            std::vector<uint64_t> t(HK_DECAY_TABLE_SIZE, 0);
+            for (uint32_t c = 0; c < HK_DECAY_TABLE_SIZE; ++c) {
+                const double decayProb = std::floor(std::pow(HK_DECAY_FACTOR, c));
+                if (decayProb >= 4294967296.0) break;
+                t[c] = (1ULL << 32) / static_cast<uint64_t>(decayProb);
+            }
+            return t;
+        }();
+        return table.data();
+    }
+
+    static uint64_t seedRng(uint64_t seed) {
+        // splitmix64, 保证 xorshift 的状态非 0
+        uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return z != 0 ? z : 1;
+    }
+
+    uint32_t nextRandom() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        return static_cast<uint32_t>(rng_ >> 32);
     }
 
     uint32_t pow2(uint32_t x) const {
@@ -212,6 +309,7 @@ private:
     TDSSummary* ss_;            
     BOBHash64* bobhash_;        
     HKNode** hkTable_;           
+    uint64_t rng_;               // 每个 sketch 独立的 xorshift64 状态, 多线程插入时互不加锁
 };
 
 #endif  // TD_HEAVYKEEPER_H
\ No newline at end of file
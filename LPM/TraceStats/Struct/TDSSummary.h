@@ -3,17 +3,24 @@
 
 #include "../../Elements/Elements.h"
 
-constexpr uint32_t TD_HASH_BITS = 12;                    
-constexpr uint32_t TD_MAX_HASH = 1U << TD_HASH_BITS;     
-constexpr uint64_t TD_HASH_MASK = (1ULL << TD_HASH_BITS) - 1;  
+constexpr uint32_t TD_MIN_HASH = 64;           // 哈希桶数取 >= topK 的 2 的幂, 至少 TD_MIN_HASH
 
 constexpr uint32_t TD_MAX_FLOW_NUM = 64;       
-constexpr uint32_t TD_MAX_FLOW_SIZE = 5000;     
 constexpr uint32_t TD_EXTRA_SIZE = 10;         
 
 class TDSSummary {
 public:
+    // 容量随 topK 分配: topK + TD_EXTRA_SIZE 个流节点
     explicit TDSSummary(uint32_t topK) : k_(topK) {
+        max_flow_size_ = topK + TD_EXTRA_SIZE;
+        hash_size_ = TD_MIN_HASH;
+        while (hash_size_ < topK) hash_size_ <<= 1;
+        hash_mask_ = hash_size_ - 1;
+
+        free_ids_.resize(max_flow_size_ + 1);
+        flow_nodes_.resize(max_flow_size_ + 1);
+        hash_heads_.resize(hash_size_);
+        hash_next_.resize(max_flow_size_ + 1);
         clear();
     }
 
@@ -22,9 +29,9 @@ public:
 
     void clear() {
         total_count_ = 0;
-        free_id_count_ = TD_MAX_FLOW_SIZE;
+        free_id_count_ = max_flow_size_;
 
-        for (uint16_t id = 0; id < TD_MAX_FLOW_SIZE + TD_EXTRA_SIZE; ++id) {
+        for (uint32_t id = 0; id <= max_flow_size_; ++id) {
             free_ids_[id] = id;
         }
 
@@ -34,16 +41,16 @@ public:
             head_nodes_[i].right = 0;
         }
 
-        for (uint32_t i = 0; i < TD_MAX_FLOW_SIZE + TD_EXTRA_SIZE; ++i) {
-            flow_nodes_[i].str.clear();
+        for (uint32_t i = 0; i <= max_flow_size_; ++i) {
+            flow_nodes_[i].key = 0;
             flow_nodes_[i].logCount = 0;
             flow_nodes_[i].pre = 0;
             flow_nodes_[i].nxt = 0;
             flow_nodes_[i].Count = 0;
         }
 
-        std::memset(hash_heads_, 0, sizeof(hash_heads_));
-        std::memset(hash_next_, 0, sizeof(hash_next_));
+        std::fill(hash_heads_.begin(), hash_heads_.end(), 0);
+        std::fill(hash_next_.begin(), hash_next_.end(), 0);
     }
 
     uint64_t calculateMemory() const {
@@ -53,37 +60,41 @@ public:
         total_memory += sizeof(total_count_);
         total_memory += sizeof(free_id_count_);
 
-        total_memory += sizeof(free_ids_);         
+        total_memory += sizeof(max_flow_size_);
+        total_memory += sizeof(hash_size_);
+        total_memory += sizeof(hash_mask_);
+
+        total_memory += free_ids_.size() * sizeof(uint32_t);         
         total_memory += sizeof(head_nodes_);        
-        total_memory += sizeof(flow_nodes_);        
-        total_memory += sizeof(hash_heads_);       
-        total_memory += sizeof(hash_next_);        
+        total_memory += flow_nodes_.size() * sizeof(FlowNode);        
+        total_memory += hash_heads_.size() * sizeof(uint32_t);       
+        total_memory += hash_next_.size() * sizeof(uint32_t);        
 
         return total_memory;
     }
 
     struct HeadNode {
-        uint16_t id;       
+        uint32_t id;       
         uint16_t left;     
         uint16_t right;    
     };
 
     struct FlowNode {
-        uint16_t pre;        
-        uint16_t nxt;        
-        uint16_t hash;       
+        uint32_t pre;        
+        uint32_t nxt;        
+        uint32_t hash;       
         uint16_t logCount;    
         uint32_t Count;      
-        std::string str;    
+        __uint128_t key;    
     };
 
-    uint16_t getLocation(uint64_t hash) const {
-        return static_cast<uint16_t>(hash & TD_HASH_MASK);
+    uint32_t getLocation(uint64_t hash) const {
+        return static_cast<uint32_t>(hash & hash_mask_);
     }
 
-    uint32_t findId(const std::string& str, uint64_t hash) const {
+    uint32_t findId(__uint128_t key, uint64_t hash) const {
         for (uint32_t id = hash_heads_[getLocation(hash)]; id != 0; id = hash_next_[id]) {
-            if (flow_nodes_[id].str == str) {
+            if (flow_nodes_[id].key == key) {
                 return id;
             }
         }
@@ -158,18 +169,18 @@ public:
             flow_nodes_[head_nodes_[logCount].id].pre = 0;
 
         } else if(flow_nodes_[node_id].nxt == 0){
-            uint16_t pre = flow_nodes_[node_id].pre;
+            uint32_t pre = flow_nodes_[node_id].pre;
             flow_nodes_[pre].nxt = 0;
 
         } else {
-            uint16_t pre = flow_nodes_[node_id].pre;
-            uint16_t nxt = flow_nodes_[node_id].nxt;
+            uint32_t pre = flow_nodes_[node_id].pre;
+            uint32_t nxt = flow_nodes_[node_id].nxt;
             flow_nodes_[pre].nxt = nxt;
             flow_nodes_[nxt].pre = pre;
         }
     }
 
-    uint16_t createNode(const std::string& flowStr, uint64_t hash, 
+    uint32_t createNode(__uint128_t key, uint64_t hash, 
                         uint16_t logCount, uint32_t originalCount) {
         removeMinNode();
         if (free_id_count_ == 0) {
@@ -177,8 +188,8 @@ public:
             exit(1);
         }
 
-        uint16_t nodeId = free_ids_[free_id_count_--];
-        flow_nodes_[nodeId].str = flowStr;
+        uint32_t nodeId = free_ids_[free_id_count_--];
+        flow_nodes_[nodeId].key = key;
         flow_nodes_[nodeId].logCount = logCount;
         flow_nodes_[nodeId].Count = originalCount;
         flow_nodes_[nodeId].hash = getLocation(hash);
@@ -186,7 +197,7 @@ public:
         flow_nodes_[nodeId].nxt = 0;
         hash_next_[nodeId] = 0;
 
-        uint16_t pos = flow_nodes_[nodeId].hash;
+        uint32_t pos = flow_nodes_[nodeId].hash;
         hash_next_[nodeId] = hash_heads_[pos];
         hash_heads_[pos] = nodeId;
         linkNode(0, nodeId);
@@ -216,7 +227,7 @@ public:
         while (total_count_ >= k_) {
             // cout<<"removeMinNode  total_count_ = "<<total_count_<<"  k = "<<k_<<endl;
             uint32_t minCount = getMinCount();
-            uint16_t minNodeId = head_nodes_[minCount].id;
+            uint32_t minNodeId = head_nodes_[minCount].id;
             if (minNodeId == 0){
                 std::cerr << "TDSSummary: 无法移除节点，链表为空！" << std::endl;
                 exit(1);
@@ -224,8 +235,7 @@ public:
 
             cutNode(minNodeId);
 
-            std::string flowStr = flow_nodes_[minNodeId].str;
-            uint16_t pos = flow_nodes_[minNodeId].hash;
+            uint32_t pos = flow_nodes_[minNodeId].hash;
             if (hash_heads_[pos] == minNodeId) {
                 hash_heads_[pos] = hash_next_[minNodeId];
             } else {
@@ -243,13 +253,16 @@ public:
     uint32_t k_;                          
     uint32_t total_count_;                
     uint32_t free_id_count_;             
-    uint16_t free_ids_[TD_MAX_FLOW_SIZE + TD_EXTRA_SIZE];  
+    uint32_t max_flow_size_;             
+    uint32_t hash_size_;                 
+    uint64_t hash_mask_;                 
+    std::vector<uint32_t> free_ids_;     
 
     HeadNode head_nodes_[TD_MAX_FLOW_NUM + TD_EXTRA_SIZE];  
-    FlowNode flow_nodes_[TD_MAX_FLOW_SIZE + TD_EXTRA_SIZE];  
+    std::vector<FlowNode> flow_nodes_;   
 
-    uint16_t hash_heads_[TD_MAX_HASH + TD_EXTRA_SIZE];    
-    uint16_t hash_next_[TD_MAX_FLOW_SIZE + TD_EXTRA_SIZE]; 
+    std::vector<uint32_t> hash_heads_;    
+    std::vector<uint32_t> hash_next_; 
 };
 
 #endif  // TD_SUMMARY_H
\ No newline at end of file
@@ -4,6 +4,7 @@ using namespace std;
 
 bool TSL::isTopKInited = false;
 vector<TopKItem> TSL::TopKStats;
+vector<double> TSL::TopKPrefixSum;
 void TSL::InitTopKStats(vector<TFNode> TF){
     int tf_size = TF.size();
     TSL::TopKStats.clear();
@@ -16,6 +17,10 @@ void TSL::InitTopKStats(vector<TFNode> TF){
         });
     }
     sort(TSL::TopKStats.begin(), TSL::TopKStats.end());
+    TSL::TopKPrefixSum.assign(tf_size + 1, 0.0);
+    for (int i = 0; i < tf_size; ++i){
+        TSL::TopKPrefixSum[i + 1] = TSL::TopKPrefixSum[i] + TSL::TopKStats[i].count;
+    }
     // for(int i = 0; i < (int)TSL::TopKStats.size() && i < 10; ++i){
     //     print_ipv6(TSL::TopKStats[i].addr);
     //     std::cout << " : " << TSL::TopKStats[i].count << std::endl;
@@ -24,26 +29,17 @@ void TSL::InitTopKStats(vector<TFNode> TF){
 }
 
 double TSL::getTopKFreq(__uint128_t addr, uint8_t prefix_len){
-    if(prefix_len == 0){
-        double total_count = 0.0;
-        for(auto it : TSL::TopKStats){
-            total_count += it.count;
-        }
-        return total_count;
-    }
+    if(TSL::TopKPrefixSum.empty()) return 0.0;
+    if(prefix_len == 0) return TSL::TopKPrefixSum.back();
 
     TopKItem start = {.addr = addr, .count = 0};
     TopKItem end = {.addr = addr | (((__uint128_t)1 << (128 - prefix_len)) - 1), .count = 0};
 
     auto it = lower_bound(TSL::TopKStats.begin(), TSL::TopKStats.end(), start); 
     auto it_end = upper_bound(TSL::TopKStats.begin(), TSL::TopKStats.end(), end); 
-    
-    double total_count = 0.0;
-    for (; it != it_end; ++it){
-        total_count += it->count;   
-    }
+    if (it >= it_end) return 0.0;
 
-    return total_count;
+    return TSL::TopKPrefixSum[it_end - TSL::TopKStats.begin()] - TSL::TopKPrefixSum[it - TSL::TopKStats.begin()];
 }
 
 size_t TSL::CalMemory(){
@@ -52,10 +48,12 @@ size_t TSL::CalMemory(){
     // total_memory += TSL::ipv6Trie.CalMemory();
 
     total_memory += TSL::TopKStats.size() * sizeof(TopKItem);
+    total_memory += TSL::TopKPrefixSum.size() * sizeof(double);
 
     return total_memory;
 }
 
 void TSL::clear(){
     TSL::TopKStats.clear();
+    TSL::TopKPrefixSum.clear();
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ class TSL{
 public:
     static bool isTopKInited;
     static vector<TopKItem> TopKStats;
+    static vector<double> TopKPrefixSum;   // TopKPrefixSum[i] = TopKStats[0..i) 的 count 之和
     static void InitTopKStats(vector<TFNode> TF);
     static double getTopKFreq(__uint128_t addr, uint8_t prefix_len);
     static size_t CalMemory();
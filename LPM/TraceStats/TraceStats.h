@@ -2,6 +2,7 @@
 #define TRACE_STATS_H
 
 #include "Struct/TDHeavyKeeper.h"
+#include "Struct/SlidingTopK.h"
 #include "TSL/TSL.h"
 
 #endif
\ No newline at end of file
@@ -13,6 +13,18 @@
 
 using namespace std;
 
+Classifier* NewClassifier(const string &method_name){
+    if (method_name == "ABST") return new ABST;
+    if (method_name == "ABST_TD") return new ABST_TD;
+    if (method_name == "DIR248") return new DIR248;
+    if (method_name == "DIR248_TD") return new DIR248_TD;
+    if (method_name == "DIR248_Compact") return new DIR248_Compact;
+    if (method_name == "Poptrie") return new Poptrie;
+    if (method_name == "Poptrie_TD") return new Poptrie_TD;
+    cout << "Unknown method_name: " << method_name << endl;
+    exit(0);
+}
+
 int main(int argc, char *argv[]){
     Command::Set(argc, argv);
     cout<<Command::output_file<<endl;
@@ -21,25 +33,48 @@ int main(int argc, char *argv[]){
     uint64_t cycles_start, cycles_end;
     ProgramState *ps = new ProgramState;
 
+    clock_gettime(CLOCK_MONOTONIC, &ts_start);
     vector<Prefix*> prefixs = ReadPrefixs(Command::prefixs_file);
-    vector<Trace*> traces = ReadTraces(Command::traces_file);
+    vector<Trace> traces = LoadTraces(Command::traces_file);
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    ps->load_time = GetTimeInSeconds(ts_start, ts_end);
+    if (Command::dump_traces != "" && !SaveTracesBinary(traces, Command::dump_traces)) {
+        cout << "dump traces to " << Command::dump_traces << " fail" << endl;
+    }
     int prefixs_num = prefixs.size();
     int traces_num = traces.size();
     ps->prefixs_num = prefixs_num;
     ps->traces_num = traces_num;
 
-    string *trace_str = new string[traces_num + 10];
     clock_gettime(CLOCK_MONOTONIC, &ts_start); 
     TDHeavyKeeper tdhk(Command::TopK, 0.4 * 1024 * 1024 / 16);
-    for(int i = 0; i < traces_num; i+=1){ 
-        trace_str[i] = traceToString(traces[i]);  
-        tdhk.insert(trace_str[i]);
-    }  
+    int sketch_threads = max(Command::sketch_threads, 1);
+    vector<TDHeavyKeeper*> core_sketch(sketch_threads, nullptr);
+    if (sketch_threads == 1) {
+        for(int i = 0; i < traces_num; i+=1){ 
+            tdhk.insert(traceTo128(&traces[i]));
+        }  
+    } else {
+        // 每个核心在自己的 sketch 上插入自己的那部分 traces, 之后合并到 tdhk
+        RunPinnedThreads(sketch_threads, [&](int tid) {
+            core_sketch[tid] = new TDHeavyKeeper(Command::TopK, 0.4 * 1024 * 1024 / 16, tid + 1);
+            int begin = (long long)traces_num * tid / sketch_threads;
+            int end = (long long)traces_num * (tid + 1) / sketch_threads;
+            for (int i = begin; i < end; ++i) {
+                core_sketch[tid]->insert(traceTo128(&traces[i]));
+            }
+        });
+    }
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
     ps->sketch_build_and_update_time = GetTimeInSeconds(ts_start, ts_end);
     ps->avg_insert_time = GetTimeInMicroSeconds(ts_start, ts_end) / (traces_num * 1.0);
 
     clock_gettime(CLOCK_MONOTONIC, &ts_start); 
+    if (sketch_threads > 1) {
+        for (auto sketch : core_sketch) {
+            tdhk.merge(*sketch);
+        }
+    }
     vector<TFNode> tdhkTF = tdhk.work();
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
     ps->sketch_calculate_topk_time = GetTimeInSeconds(ts_start, ts_end);
@@ -52,28 +87,37 @@ int main(int argc, char *argv[]){
     ps->rules_memory_size = prefixs_num * sizeof(Prefix) / 1024.0 / 1024.0;
     ps->traces_memory_size = traces_num * sizeof(Trace) / 1024.0 / 1024.0;
     ps->sketch_memory_size = 1.0 * tdhk.calculateMemory() / 1024 / 1024;
+    for (auto sketch : core_sketch) {
+        if (sketch == nullptr) continue;
+        ps->sketch_memory_size += 1.0 * sketch->calculateMemory() / 1024 / 1024;
+        delete sketch;
+    }
     ps->topk_tracesFreq_memory_size = tdhkTF.size() * sizeof(TFNode) / 1024.0 / 1024.0; 
 	ps->TracesMat_memory_size = TSL::CalMemory() / 1024.0 / 1024.0;
     cout << "TSL init over" << std::endl;
 
-    bool is_Mat = false;
-    Classifier *classifier;
-    if (Command::method_name == "ABST" ){
-        classifier = new ABST;
-    } else if (Command::method_name == "ABST_TD" ){
-        is_Mat = true;
-        classifier = new ABST_TD;
-    } else if (Command::method_name == "DIR248" ){
-        classifier = new DIR248;
-    } else if (Command::method_name == "DIR248_TD" ){
-        is_Mat = true;
-        classifier = new DIR248_TD;
-    } else if (Command::method_name == "Poptrie" ){
-        classifier = new Poptrie;
-    } else if (Command::method_name == "Poptrie_TD" ){
-        is_Mat = true;
-        classifier = new Poptrie_TD;
-    } else if (Command::method_name == "Auto" ){
+    if (Command::window > 0) {
+        // 按 window 个包的滑动窗口重放 traces, 每滑过一个窗口计算一次相对构建时 TopK 的漂移
+        SlidingTopK sliding(Command::TopK, 0.4 * 1024 * 1024 / 16, Command::window, SLIDING_TOPK_EPOCHS);
+        double total_drift = 0;
+        for (int i = 0; i < traces_num; ++i) {
+            sliding.insert(traceTo128(&traces[i]));
+            if ((i + 1) % Command::window == 0) {
+                double drift = SlidingTopK::drift(tdhkTF, sliding.work());
+                total_drift += drift;
+                ps->window_num++;
+                ps->window_max_drift = max(ps->window_max_drift, drift);
+                ps->window_last_drift = drift;
+                if (drift > SLIDING_TOPK_DRIFT_THRESHOLD) ps->window_rebuild_num++;
+            }
+        }
+        ps->window_size = Command::window;
+        if (ps->window_num > 0) ps->window_avg_drift = total_drift / ps->window_num;
+        cout << "sliding window over" << std::endl;
+    }
+
+    string method_name = Command::method_name;
+    if (method_name == "Auto" ){
         clock_gettime(CLOCK_MONOTONIC, &ts_start);
         unordered_map<uint8_t, int> lenCount;
         for (auto* p : prefixs) {
@@ -94,19 +138,44 @@ int main(int argc, char *argv[]){
         clock_gettime(CLOCK_MONOTONIC, &ts_end);
         ps->rules_analyze_time = GetTimeInSeconds(ts_start, ts_end);
 
-        is_Mat = true;
         if(N_eff > m_star){
             Poptrie_TD::TOP_LEVEL_STRIDE = 16;
-            classifier = new Poptrie_TD;
+            method_name = "Poptrie_TD";
         } else {
-            classifier = new ABST_TD;
+            method_name = "ABST_TD";
         }
     }
+    bool is_Mat = (method_name == "ABST_TD" || method_name == "DIR248_TD" || method_name == "Poptrie_TD");
+    Classifier *classifier = NewClassifier(method_name);
     
-	clock_gettime(CLOCK_MONOTONIC, &ts_start);
-    classifier->Create(prefixs, ps);
-	clock_gettime(CLOCK_MONOTONIC, &ts_end);
-    ps->tree_build_time = GetTimeInSeconds(ts_start, ts_end);
+    // 快照文件已存在时直接映射, 否则照常构建并把结果写成快照
+    bool loaded = false;
+    string snapshot_file = Command::snapshot_file;
+    if (snapshot_file != "" && access(snapshot_file.c_str(), F_OK) == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        loaded = classifier->Load(snapshot_file);
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        if (loaded) ps->snapshot_load_time = GetTimeInSeconds(ts_start, ts_end);
+        else cout << "load snapshot " << snapshot_file << " fail, rebuild " << method_name << endl;
+    }
+
+    if (!loaded) {
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        classifier->Create(prefixs, ps);
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->tree_build_time = GetTimeInSeconds(ts_start, ts_end);
+    }
+
+    if (snapshot_file != "" && !loaded) {
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        if (!classifier->Save(snapshot_file)) cout << "save snapshot " << snapshot_file << " fail" << endl;
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->snapshot_save_time = GetTimeInSeconds(ts_start, ts_end);
+    }
+    if (snapshot_file != "") {
+        ifstream snapshot(snapshot_file, ios::binary | ios::ate);
+        if (snapshot) ps->snapshot_size = snapshot.tellg() / 1024.0 / 1024.0;
+    }
     
     ps->tree_memory_size = classifier->CalMemory() / 1024.0 / 1024.0;
     if(is_Mat){
@@ -115,20 +184,21 @@ int main(int argc, char *argv[]){
         ps->total_build_time += ps->topk_tracesMat_init_time;
         if (Command::method_name == "Auto" ) ps->total_build_time += ps->rules_analyze_time;
         ps->total_build_time += ps->tree_build_time;
+        ps->total_build_time += ps->snapshot_load_time;
 
         ps->total_memory_size += ps->sketch_memory_size;
         ps->total_memory_size += ps->topk_tracesFreq_memory_size;
         ps->total_memory_size += ps->TracesMat_memory_size; 
         ps->total_memory_size += ps->tree_memory_size;
     } else {
-        ps->total_build_time = ps->tree_build_time;
+        ps->total_build_time = ps->tree_build_time + ps->snapshot_load_time;
         ps->total_memory_size += ps->tree_memory_size;
     }
 	std::cout<<"Create over!"<<std::endl;
 
     vector<uint32_t> Ans;
     for (int i = 0; i < traces_num; ++i){
-        Ans.push_back(classifier->Lookup(traces[i], ps));
+        Ans.push_back(classifier->Lookup(&traces[i], ps));
     }
 
     int lookup_round = Command::lookup_round;
@@ -136,7 +206,7 @@ int main(int argc, char *argv[]){
     clock_gettime(CLOCK_MONOTONIC, &ts_start);
 	for (int k = 0; k < lookup_round; ++k){
 		for (int i = 0; i < traces_num; ++i){
-            classifier->Lookup(traces[i]);
+            classifier->Lookup(&traces[i]);
 		}
 	}
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
@@ -144,6 +214,301 @@ int main(int argc, char *argv[]){
     ps->avg_lookup_time = total_lookup_times / (lookup_round * traces_num * 1.0);
     ps->throughput = (traces_num * lookup_round) / (total_lookup_times / 1e6); // pps
     cout << "lookup over!" <<endl;
+
+    if (Command::batch_size > 0) {
+        int batch_size = Command::batch_size;
+        vector<uint32_t> batch_ans(traces_num);
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        for (int k = 0; k < lookup_round; ++k){
+            for (int i = 0; i < traces_num; i += batch_size){
+                classifier->LookupBatch(&traces[i], min(batch_size, traces_num - i), &batch_ans[i]);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->batch_throughput = (traces_num * lookup_round) / (GetTimeInMicroSeconds(ts_start, ts_end) / 1e6); // pps
+
+        for (int i = 0; i < traces_num; ++i){
+            if (batch_ans[i] != Ans[i]) {
+                cout << "LookupBatch mismatch at trace " << i << " : " << batch_ans[i] << " != " << Ans[i] << endl;
+                break;
+            }
+        }
+        cout << "batch lookup over!" <<endl;
+    }
+
+    // 只有 DIR248 / DIR248_TD 实现了 AMAC 预取查找, 其它方法不计时, prefetch_* 保持 0
+    if (Command::prefetch_width > 0 && method_name != "DIR248" && method_name != "DIR248_TD") {
+        cout << "prefetch lookup is only supported by DIR248 / DIR248_TD" << endl;
+    } else if (Command::prefetch_width > 0) {
+        int batch_size = Command::batch_size > 0 ? Command::batch_size : traces_num;
+        vector<uint32_t> prefetch_ans(traces_num);
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        for (int k = 0; k < lookup_round; ++k){
+            for (int i = 0; i < traces_num; i += batch_size){
+                classifier->LookupBatchPrefetch(&traces[i], min(batch_size, traces_num - i), &prefetch_ans[i], Command::prefetch_width);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->prefetch_throughput = (traces_num * lookup_round) / (GetTimeInMicroSeconds(ts_start, ts_end) / 1e6); // pps
+        ps->prefetch_gain = ps->prefetch_throughput / ps->throughput;
+
+        for (int i = 0; i < traces_num; ++i){
+            if (prefetch_ans[i] != Ans[i]) {
+                cout << "prefetch lookup mismatch at trace " << i << " : " << prefetch_ans[i] << " != " << Ans[i] << endl;
+                break;
+            }
+        }
+        cout << "prefetch lookup over!" <<endl;
+    }
+
+    if (Command::ring_size > 0) {
+        // 模拟收包环: 每个 burst 的报文按到达顺序拷进环上连续的槽位, 再对这些槽位批量查找
+        int ring_size = Command::ring_size;
+        int burst = min(Command::batch_size > 0 ? Command::batch_size : 32, ring_size);
+        vector<Trace> ring(ring_size);
+        vector<uint32_t> out(burst);
+        int head = 0, mismatch = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        for (int k = 0; k < lookup_round; ++k) {
+            for (int i = 0; i < traces_num; i += burst) {
+                int n = min(burst, traces_num - i);
+                if (head + n > ring_size) head = 0;
+                memcpy(&ring[head], &traces[i], n * sizeof(Trace));
+                classifier->LookupBatch(&ring[head], n, out.data());
+                head += n;
+                if (k == 0) {
+                    for (int j = 0; j < n; ++j) mismatch += (out[j] != Ans[i + j]);
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->ring_size = ring_size;
+        ps->ring_throughput = (traces_num * lookup_round) / (GetTimeInMicroSeconds(ts_start, ts_end) / 1e6); // pps
+        if (mismatch > 0) cout << "ring lookup mismatch " << mismatch << " traces" << endl;
+        cout << "ring lookup over!" <<endl;
+    }
+
+    if (Command::latency_batch > 0) {
+        // 每次对 latency_batch 个报文计时, 扣除 rdtsc 的固定开销后按每包周期数记入直方图
+        int batch = Command::latency_batch;
+        vector<uint32_t> out(batch);
+        LatencyHistogram hist;
+        uint64_t overhead = CalibrateLatencyOverhead(10000);
+
+        for (int k = 0; k < lookup_round; ++k) {
+            for (int i = 0; i < traces_num; i += batch) {
+                int n = min(batch, traces_num - i);
+                uint64_t start = LatencyStart();
+                if (batch == 1) out[0] = classifier->Lookup(&traces[i]);
+                else classifier->LookupBatch(&traces[i], n, out.data());
+                uint64_t cycles = LatencyStop() - start;
+                cycles = cycles > overhead ? cycles - overhead : 0;
+                hist.Record(cycles / n);
+            }
+        }
+        ps->latency_batch = batch;
+        ps->latency_samples = hist.Count();
+        ps->latency_overhead = overhead;
+        ps->latency_p50 = hist.Percentile(50);
+        ps->latency_p90 = hist.Percentile(90);
+        ps->latency_p99 = hist.Percentile(99);
+        ps->latency_p999 = hist.Percentile(99.9);
+        ps->latency_max = hist.Max();
+        cout << "latency lookup over!" <<endl;
+    }
+
+    if (Command::threads > 0) {
+        // 每个线程绑定一个核心, 对 traces 的一个分片查询 lookup_round 轮
+        vector<uint64_t> checksum(Command::threads, 0);
+        for (int threads : ScalingThreadCounts(Command::threads)) {
+            vector<double> times = RunPinnedThreads(threads, [&](int tid) {
+                int begin = (long long)traces_num * tid / threads;
+                int end = (long long)traces_num * (tid + 1) / threads;
+                uint64_t sum = 0;
+                for (int k = 0; k < lookup_round; ++k) {
+                    for (int i = begin; i < end; ++i) {
+                        sum += classifier->Lookup(&traces[i]);
+                    }
+                }
+                checksum[tid] += sum;
+            });
+
+            // 总吞吐量按最慢线程的完成时间计算
+            double makespan = 0;
+            vector<double> per_thread(threads, 0);
+            for (int tid = 0; tid < threads; ++tid) {
+                int shard = (long long)traces_num * (tid + 1) / threads - (long long)traces_num * tid / threads;
+                if (times[tid] > 0) per_thread[tid] = (double)shard * lookup_round / times[tid] * 1e6; // pps
+                makespan = max(makespan, times[tid]);
+            }
+            double aggregate = makespan > 0 ? (double)traces_num * lookup_round / makespan * 1e6 : 0; // pps
+            ps->scaling_threads.push_back(threads);
+            ps->scaling_throughput.push_back(aggregate);
+            double base = ps->scaling_throughput[0];
+            ps->scaling_efficiency.push_back(base > 0 ? aggregate / (threads * base) : 0);
+            if (threads == Command::threads) ps->thread_throughput = per_thread;
+        }
+        if (Command::threads > OnlineCores()) {
+            cout << "threads " << Command::threads << " > online cores " << OnlineCores() << ", workers share cores" << endl;
+        }
+        cout << "multi-thread lookup over!" <<endl;
+    }
+
+    vector<PrefixUpdate> updates;
+    if (Command::update_file != "") {
+        updates = ReadUpdates(Command::update_file);
+        if (dynamic_cast<Poptrie_TD*>(classifier) == nullptr) {
+            cout << "incremental update is only supported by Poptrie_TD" << endl;
+        } else {
+            double total_update_time = 0;
+            for (auto &update : updates) {
+                clock_gettime(CLOCK_MONOTONIC, &ts_start);
+                if (update.withdraw) classifier->Delete(&update.prefix);
+                else classifier->Insert(&update.prefix);
+                clock_gettime(CLOCK_MONOTONIC, &ts_end);
+
+                double update_time = GetTimeInMicroSeconds(ts_start, ts_end);
+                total_update_time += update_time;
+                ps->max_update_time = max(ps->max_update_time, update_time);
+            }
+            ps->updates_num = updates.size();
+            if (!updates.empty()) ps->avg_update_time = total_update_time / updates.size();
+            cout << "update over!" <<endl;
+        }
+    }
+
+    if (Command::rcu_readers > 0 && updates.empty()) {
+        cout << "rcu benchmark needs a non-empty --update_file" << endl;
+    } else if (Command::rcu_readers > 0) {
+        bool incremental = dynamic_cast<Poptrie_TD*>(classifier) != nullptr;
+        RcuClassifier rcu([&](){ return NewClassifier(method_name); }, prefixs, incremental);
+
+        int readers = Command::rcu_readers;
+        size_t burst = Command::batch_size > 0 ? Command::batch_size : 64;
+        atomic<bool> stop(false);
+        atomic<int> ready(0);
+        vector<uint64_t> reader_lookups(readers, 0);
+        vector<double> reader_time(readers, 0);
+        vector<thread> threads;
+        for (int r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r]() {
+                PinThreadToCore(r + 1);
+                int id = rcu.RegisterReader();
+                vector<uint32_t> out(burst);
+                struct timespec t_start, t_end;
+                uint64_t lookups = 0;
+                size_t pos = (size_t)traces_num * r / readers;
+                ready++;
+                clock_gettime(CLOCK_MONOTONIC, &t_start);
+                while (!stop.load(memory_order_relaxed)) {
+                    size_t n = min(burst, (size_t)traces_num - pos);
+                    rcu.LookupBatch(id, &traces[pos], n, out.data());
+                    lookups += n;
+                    pos += n;
+                    if (pos >= (size_t)traces_num) pos = 0;
+                }
+                clock_gettime(CLOCK_MONOTONIC, &t_end);
+                reader_lookups[r] = lookups;
+                reader_time[r] = GetTimeInMicroSeconds(t_start, t_end);
+            });
+        }
+        while (ready.load() < readers) this_thread::yield();
+
+        double total_publish_time = 0, total_grace_time = 0;
+        for (size_t i = 0; i < updates.size(); i += RCU_UPDATE_BATCH) {
+            rcu.Update(&updates[i], min((size_t)RCU_UPDATE_BATCH, updates.size() - i));
+            total_publish_time += rcu.last_publish_time;
+            total_grace_time += rcu.last_grace_time;
+            ps->rcu_publish_num++;
+        }
+        stop = true;
+        for (auto &t : threads) t.join();
+
+        ps->rcu_readers = readers;
+        ps->rcu_avg_publish_time = total_publish_time / ps->rcu_publish_num;
+        ps->rcu_avg_grace_time = total_grace_time / ps->rcu_publish_num;
+        for (int r = 0; r < readers; ++r) {
+            double reader_throughput = reader_lookups[r] / (reader_time[r] / 1e6); // pps
+            ps->rcu_reader_throughput.push_back(reader_throughput);
+            ps->rcu_throughput += reader_throughput;
+        }
+
+        if (incremental) {
+            int id = rcu.RegisterReader();
+            for (int i = 0; i < traces_num; ++i){
+                uint32_t port = rcu.Lookup(id, &traces[i]);
+                if (port != classifier->Lookup(&traces[i])) {
+                    cout << "rcu lookup mismatch at trace " << i << " : " << port << " != " << classifier->Lookup(&traces[i]) << endl;
+                    break;
+                }
+            }
+        }
+        cout << "rcu benchmark over!" <<endl;
+    }
+
+    if (Command::reoptimize > 0 && !is_Mat) {
+        cout << "background re-optimization is only supported by TD methods" << endl;
+    } else if (Command::reoptimize > 0) {
+        // 读者线程持续查询; 主线程模拟数据面, 每 reoptimize 个包把滑动窗口 TopK 交给后台优化线程
+        RcuClassifier rcu([&](){ return NewClassifier(method_name); }, prefixs, false);
+        TDOptimizer optimizer(&rcu, TD_OPTIMIZER_THRESHOLD);
+        optimizer.Start();
+
+        size_t burst = Command::batch_size > 0 ? Command::batch_size : 64;
+        atomic<bool> stop(false);
+        uint64_t reader_lookups = 0;
+        double reader_time = 0, max_burst_time = 0;
+        thread reader([&]() {
+            PinThreadToCore(1);
+            int id = rcu.RegisterReader();
+            vector<uint32_t> out(burst);
+            struct timespec t_start, t_end, b_start, b_end;
+            size_t pos = 0;
+            clock_gettime(CLOCK_MONOTONIC, &t_start);
+            while (!stop.load(memory_order_relaxed)) {
+                size_t n = min(burst, (size_t)traces_num - pos);
+                clock_gettime(CLOCK_MONOTONIC, &b_start);
+                rcu.LookupBatch(id, &traces[pos], n, out.data());
+                clock_gettime(CLOCK_MONOTONIC, &b_end);
+                max_burst_time = max(max_burst_time, GetTimeInMicroSeconds(b_start, b_end));
+                reader_lookups += n;
+                pos += n;
+                if (pos >= (size_t)traces_num) pos = 0;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t_end);
+            reader_time = GetTimeInMicroSeconds(t_start, t_end);
+        });
+
+        SlidingTopK sliding(Command::TopK, 0.4 * 1024 * 1024 / 16, Command::reoptimize, SLIDING_TOPK_EPOCHS);
+        for (int i = 0; i < traces_num; ++i) {
+            sliding.insert(traceTo128(&traces[i]));
+            if ((i + 1) % Command::reoptimize == 0) optimizer.Offer(sliding.work());
+        }
+        optimizer.Stop();
+        stop = true;
+        reader.join();
+
+        ps->reopt_rounds = optimizer.rounds;
+        ps->reopt_swaps = optimizer.swaps;
+        if (optimizer.rounds > 0) ps->reopt_avg_build_time = optimizer.total_build_time / optimizer.rounds;
+        ps->reopt_current_access = optimizer.last_current_access;
+        ps->reopt_candidate_access = optimizer.last_candidate_access;
+        if (reader_time > 0) ps->reopt_reader_throughput = reader_lookups / (reader_time / 1e6); // pps
+        ps->reopt_max_burst_time = max_burst_time;
+
+        int id = rcu.RegisterReader();
+        for (int i = 0; i < traces_num; ++i){
+            uint32_t port = rcu.Lookup(id, &traces[i]);
+            if (port != Ans[i]) {
+                cout << "re-optimized lookup mismatch at trace " << i << " : " << port << " != " << Ans[i] << endl;
+                break;
+            }
+        }
+        cout << "re-optimization over!" <<endl;
+    }
     
     ps->CalInfo();
     ps->Print();
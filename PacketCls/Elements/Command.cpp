@@ -9,6 +9,9 @@ string Command::traces_file = "";
 string Command::output_file = ""; 
 int Command::lookup_round = 0;  
 int Command::topk_num = 0;
+int Command::threads = 0;
+int Command::batch_size = 0;
+int Command::ring_size = 0;
 
 bool Command::Set(int argc, char *argv[]) {
 	char short_opts[] = "";   
@@ -20,6 +23,9 @@ bool Command::Set(int argc, char *argv[]) {
         {"output_file",   required_argument, NULL, 5}, 
         {"lookup_round",  required_argument, NULL, 6},   
         {"topk_num",      required_argument, NULL, 7},
+        {"threads",       required_argument, NULL, 8},
+        {"batch_size",    required_argument, NULL, 9},
+        {"ring_size",     required_argument, NULL, 10},
         {0,               0,                 0,    0} 
     };
 
@@ -47,6 +53,15 @@ bool Command::Set(int argc, char *argv[]) {
         case 7:
             topk_num = strtoul(optarg, NULL, 0);
             break;
+        case 8:
+            threads = strtoul(optarg, NULL, 0);
+            break;
+        case 9:
+            batch_size = strtoul(optarg, NULL, 0);
+            break;
+        case 10:
+            ring_size = strtoul(optarg, NULL, 0);
+            break;
         default:
             cout << "Wrong command " << opt << endl;
             exit(0);
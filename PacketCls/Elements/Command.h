@@ -16,6 +16,9 @@ public:
 
     static int lookup_round;    
     static int topk_num;        
+    static int threads;         
+    static int batch_size;         
+    static int ring_size;         
 
     static bool Set(int argc, char *argv[]);  
 };
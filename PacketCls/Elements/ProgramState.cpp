@@ -12,6 +12,7 @@ CountState::CountState(){
 }
 
 void CountState::Addcount() { ++cnt; } 
+void CountState::Addcount(long long n) { cnt += n; }
 void CountState::Cal() {
     maxn = max(maxn,cnt);
     minn = min(minn,cnt);
@@ -34,18 +35,26 @@ DecisionTreeInfo::DecisionTreeInfo(){
 	tree_memory_size = 0;
 }
 
+// 建树时子树由多个 OpenMP task 并行构造, 统计信息的更新需要互斥
 void DecisionTreeInfo::AddDims(int dim1, int dim2){
-    dimInfo[dim1]++;
-    dimInfo[dim2]++;
+    #pragma omp critical (DecisionTreeInfo)
+    {
+        dimInfo[dim1]++;
+        dimInfo[dim2]++;
+    }
 }
 
 void DecisionTreeInfo::AddNode(int depth){
+    #pragma omp critical (DecisionTreeInfo)
     depthInfo[depth]++;
 }
 
 void DecisionTreeInfo::AddNode(int depth, int rules_num){
-    depthInfo[depth]++;
-    leafInfo[rules_num]++;
+    #pragma omp critical (DecisionTreeInfo)
+    {
+        depthInfo[depth]++;
+        leafInfo[rules_num]++;
+    }
 }
 
 void DecisionTreeInfo::Print(FILE *fp){
@@ -79,9 +88,16 @@ ProgramState::ProgramState(){
     rules_num = traces_num = topk_traces_num = 0;         
 	rules_memory_size = traces_memory_size = sketch_memory_size = topk_tracesFreq_memory_size = TracesMat_memory_size = total_memory_size = 0;              
     sketch_build_and_update_time = sketch_calculate_topk_time = topk_tracesMat_init_time = rules_analyze_time = tree_build_time = total_build_time = 0; 
+    tree_build_peak_rss = 0;
 
     avg_insert_time = 0;
     avg_lookup_time = 0;
+    throughput = ring_throughput = 0;
+    ring_size = 0;
+    scaling_threads.clear();
+    scaling_throughput.clear();
+    scaling_efficiency.clear();
+    thread_throughput.clear();
 
     avg_lookup_access = max_lookup_access = 0;
     avg_lookup_depth = 0;
@@ -101,9 +117,16 @@ void ProgramState::Clear(){
 
 	rules_memory_size = traces_memory_size = sketch_memory_size = topk_tracesFreq_memory_size = TracesMat_memory_size = total_memory_size = 0;              
     sketch_build_and_update_time = sketch_calculate_topk_time = topk_tracesMat_init_time = rules_analyze_time = tree_build_time = total_build_time = 0; 
+    tree_build_peak_rss = 0;
     
     avg_insert_time = 0;
     avg_lookup_time = 0;
+    throughput = ring_throughput = 0;
+    ring_size = 0;
+    scaling_threads.clear();
+    scaling_throughput.clear();
+    scaling_efficiency.clear();
+    thread_throughput.clear();
 
     avg_lookup_access = max_lookup_access = 0;
     avg_lookup_depth = 0;
@@ -145,11 +168,24 @@ void ProgramState::Print(){
     fprintf(fp, "topk_tracesMat_init_time:     %.8lf S\n", topk_tracesMat_init_time);
     fprintf(fp, "rules_analyze_time:           %.8lf S\n", rules_analyze_time);
     fprintf(fp, "tree_build_time:              %.8lf S\n", tree_build_time);
+    fprintf(fp, "tree_build_peak_rss:          %.8lf MB\n", tree_build_peak_rss);
     fprintf(fp, "total_build_time:             %.8lf S\n\n", total_build_time);
 
     fprintf(fp, "avg_lookup_time:        %.8lf US\n", avg_lookup_time);
     fprintf(fp, "avg_insert_time:        %.8lf US\n", avg_insert_time);
-
+    fprintf(fp, "throughput:             %.8lf pps\n", throughput);
+    if (ring_size > 0) {
+        fprintf(fp, "ring_size:              %d\n", ring_size);
+        fprintf(fp, "ring_throughput:        %.8lf pps\n", ring_throughput);
+    }
+    if (!scaling_threads.empty()) fprintf(fp, "\n");
+    for (size_t i = 0; i < scaling_threads.size(); ++i) {
+        fprintf(fp, "threads_%d_throughput:      %.8lf pps (efficiency %.4lf)\n", scaling_threads[i], scaling_throughput[i], scaling_efficiency[i]);
+    }
+    for (size_t i = 0; i < thread_throughput.size(); ++i) {
+        fprintf(fp, "thread_%zu_throughput:      %.8lf pps\n", i, thread_throughput[i]);
+    }
+    if (!scaling_threads.empty()) fprintf(fp, "\n");
     fprintf(fp, "avg_lookup_access:        %.8lf\n", avg_lookup_access);
     fprintf(fp, "max_lookup_access:        %.0lf\n", max_lookup_access);
     fprintf(fp, "avg_lookup_depth:         %.8lf\n", avg_lookup_depth);
@@ -17,6 +17,7 @@ public:
 
     CountState();      
 	void Addcount();  
+	void Addcount(long long n);
 	void Cal();       
 	void Clear();      
 };
@@ -54,6 +55,7 @@ public:
 	double topk_tracesMat_init_time;        
 	double rules_analyze_time;              
 	double tree_build_time;                 
+	double tree_build_peak_rss;
 	double total_build_time;                 
 	
 	CountState lookup_access_nodes;          
@@ -63,6 +65,14 @@ public:
 
 	double avg_lookup_time;
 	double avg_insert_time;
+	double throughput;
+	int ring_size;
+	double ring_throughput;
+
+	vector<int> scaling_threads;
+	vector<double> scaling_throughput;
+	vector<double> scaling_efficiency;
+	vector<double> thread_throughput;
 
 	double avg_lookup_access;               
 	double max_lookup_access;               
@@ -10,6 +10,9 @@ public:
     virtual void Create(vector<Rule*> &rules, ProgramState *ps) = 0;  
     virtual uint32_t Lookup(Trace *trace, ProgramState *ps) = 0;     
     virtual uint32_t Lookup(Trace *trace) = 0;                       
+    virtual void LookupBatch(Trace *traces, size_t n, uint32_t *out) {    
+        for (size_t i = 0; i < n; ++i) out[i] = Lookup(&traces[i]);
+    }
     virtual uint64_t CalMemory() = 0;                                
 };
 
@@ -39,10 +39,14 @@ void EffiCuts::Create(vector<Rule*> &rules, ProgramState *ps) {
     
     tree_num = ans.size();
     root = new EffiNode*[tree_num];
+    // 各子树相互独立, 每棵树作为一个 task 构造
+    #pragma omp parallel
+    #pragma omp single
     for(int i = 0; i < tree_num; i++){
         root[i] = new EffiNode;
         root[i]->rules = category.sub[ans[i].first][ans[i].second]->rules;
         root[i]->rules_num = root[i]->rules.size();
+        #pragma omp task
         root[i]->Create(ps, 0);
     }
 	sort(root, root + tree_num, CmpEffiNodePriority);
@@ -92,17 +96,19 @@ uint32_t EffiCuts::Lookup(Trace *trace, ProgramState *ps) {
 
         if(flag) continue;
         
-        for (int j = 0; j < node->rules_num; ++j) {
-            ps->lookup_access_rules.Addcount();
-		    ps->lookup_access.Addcount();
-            if(ans >= node->rules[j]->priority){
-                break;
-            }
-            if (MatchRuleTrace(node->rules[j], trace) && ans < node->rules[j]->priority){
-                ans = node->rules[j]->priority;
+        // 规则按优先级降序, 逐条扫描会在优先级不超过 ans 的位置提前停下, 访问规则数按此计算
+        int pos = node->block.Match(trace);
+        int scanned = pos < 0 ? node->rules_num : pos + 1;
+        for (int j = 0; j < scanned; ++j) {
+            if (ans >= node->block.Priority(j)) {
+                scanned = j + 1;
+                pos = -1;
                 break;
             }
         }
+        ps->lookup_access_rules.Addcount(scanned);
+		ps->lookup_access.Addcount(scanned);
+        if (pos >= 0) ans = node->block.Priority(pos);
 	}
     ps->lookup_access_nodes.Cal();
     ps->lookup_access_rules.Cal();
@@ -148,15 +154,9 @@ uint32_t EffiCuts::Lookup(Trace *trace) {
         }
         if(flag) continue;
         
-        for (int j = 0; j < node->rules_num; ++j) {
-            if(ans >= node->rules[j]->priority){
-                break;
-            }
-            if (MatchRuleTrace(node->rules[j], trace) && ans < node->rules[j]->priority){
-                ans = node->rules[j]->priority;
-                break;
-            }
-        }
+        int pos = node->block.Match(trace);
+        if (pos >= 0 && ans < node->block.Priority(pos))
+            ans = node->block.Priority(pos);
 	}
 	return ans;
 }
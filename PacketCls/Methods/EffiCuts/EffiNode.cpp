@@ -37,6 +37,9 @@ void EffiNode::Create(ProgramState *ps, int depth) {
 
     if (depth == EffiCuts::max_depth || rules_num <= EffiCuts::leaf_size) {
         leaf_node = true;      
+        block.Build(rules);
+        // 叶节点查找只读 block, 规则指针数组随即释放, rules_num 仍保留规则数
+        vector<Rule*>().swap(rules);
         ps->DTI.AddNode(depth, rules_num);
         return;                      
     }
@@ -110,6 +113,8 @@ void EffiNode::Create(ProgramState *ps, int depth) {
         child_num = 0; 
 
         leaf_node = true; 
+        block.Build(rules);
+        vector<Rule*>().swap(rules);
         ps->DTI.AddNode(depth, rules_num);
         return;
     }
@@ -144,9 +149,11 @@ void EffiNode::Create(ProgramState *ps, int depth) {
     
     for (int i = 0; i < child_num; ++i){
         if (vis[i]) {
+            #pragma omp task if (child_arr[i]->rules_num >= TREE_TASK_MIN_RULES)
             child_arr[i]->Create(ps, depth+1); 
         }
     }
+    #pragma omp taskwait
 
     rules.clear();
     ps->DTI.AddNode(depth);
@@ -155,6 +162,7 @@ void EffiNode::Create(ProgramState *ps, int depth) {
 uint64_t EffiNode::CalMemory() {
     uint64_t size = sizeof(EffiNode);
     size += rules.capacity() * sizeof(Rule*);
+    size += block.CalMemory();
     if (child_arr != nullptr) {
         size += child_num * sizeof(EffiNode*);
         map<EffiNode*, int> child_map;
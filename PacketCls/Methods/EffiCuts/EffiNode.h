@@ -23,6 +23,7 @@ public:
 
     EffiNode** child_arr;  
     int child_num;         
+    RuleBlock block;       
 
     EffiNode();
     void Create(vector<Rule*> &rules, ProgramState *ps, int depth){};  
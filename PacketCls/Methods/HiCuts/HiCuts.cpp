@@ -31,6 +31,8 @@ void HiCuts::Create(vector<Rule*> &rules, ProgramState *ps) {
     root = new HiNode;
     root->rules = rules;
     root->rules_num = rules_nums;
+    #pragma omp parallel
+    #pragma omp single
     root->Create(ps, 0);
 }
 
@@ -137,9 +137,11 @@ void HiNode::Create(ProgramState *ps, int depth) {
     
     for (int i = 0; i < child_num; ++i){
         if (vis[i]) {
+            #pragma omp task if (child_arr[i]->rules_num >= TREE_TASK_MIN_RULES)
             child_arr[i]->Create(ps, depth+1); 
         }
     }
+    #pragma omp taskwait
     rules.clear();
     ps->DTI.AddNode(depth);
 }
@@ -37,6 +37,8 @@ void HyperCuts::Create(vector<Rule*> &rules, ProgramState *ps) {
     root = new HcNode;
     root->rules = rules;
     root->rules_num = rules_nums;
+    #pragma omp parallel
+    #pragma omp single
     root->Create(ps, 0);
 }
 
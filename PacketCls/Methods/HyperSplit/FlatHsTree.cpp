@@ -0,0 +1,54 @@
+#include "FlatHsTree.h"
+
+using namespace std;
+
+uint32_t FlatHsTree::Lookup(Trace *trace, ProgramState *ps) {
+    const FlatHsNode *node = nodes.data();
+    while ((node->meta >> FLAT_HS_DIM_SHIFT) != FLAT_HS_LEAF) {
+        ps->lookup_access_nodes.Addcount();
+        ps->lookup_access.Addcount();
+
+        uint32_t child = (node->meta & FLAT_HS_INDEX_MASK) + (trace->key[node->meta >> FLAT_HS_DIM_SHIFT] > node->value);
+        node = &nodes[child];
+        ps->lookup_depth.Addcount();
+    }
+    ps->lookup_access_nodes.Addcount();
+    ps->lookup_access.Addcount();
+
+    uint32_t ans = 0;
+    uint32_t rules_num = node->meta & FLAT_HS_INDEX_MASK;
+    // 空叶子的 value 可能等于 rule_pool.size(), 不能取下标
+    const uint32_t *block = rules_num ? &rule_pool[node->value] : NULL;
+    int pos = MatchRuleBlock(block, rules_num, trace->key);
+    // 访问规则数按逐条扫描到命中为止计算, 与未向量化时一致
+    uint32_t scanned = pos < 0 ? rules_num : pos + 1;
+    ps->lookup_access_rules.Addcount(scanned);
+    ps->lookup_access.Addcount(scanned);
+    if (pos >= 0) ans = RuleBlockPriority(block, rules_num, pos);
+    ps->lookup_access_nodes.Cal();
+    ps->lookup_access_rules.Cal();
+    ps->lookup_access.Cal();
+    ps->lookup_depth.Cal();
+    return ans;
+}
+
+uint32_t FlatHsTree::Lookup(Trace *trace) {
+    const FlatHsNode *node = nodes.data();
+    uint32_t meta = node->meta;
+    while ((meta >> FLAT_HS_DIM_SHIFT) != FLAT_HS_LEAF) {
+        node = &nodes[(meta & FLAT_HS_INDEX_MASK) + (trace->key[meta >> FLAT_HS_DIM_SHIFT] > node->value)];
+        meta = node->meta;
+    }
+
+    uint32_t rules_num = meta & FLAT_HS_INDEX_MASK;
+    const uint32_t *block = rules_num ? &rule_pool[node->value] : NULL;
+    int pos = MatchRuleBlock(block, rules_num, trace->key);
+    return pos < 0 ? 0 : RuleBlockPriority(block, rules_num, pos);
+}
+
+uint64_t FlatHsTree::CalMemory() {
+    uint64_t memory_size = sizeof(FlatHsTree);
+    memory_size += nodes.capacity() * sizeof(FlatHsNode);
+    memory_size += rule_pool.capacity() * sizeof(uint32_t);
+    return memory_size;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef  FLAT_HS_TREE_H
+#define  FLAT_HS_TREE_H
+
+#include "../../Elements/Elements.h"
+#include "../../Tools/Tools.h"
+
+using namespace std;
+
+#define FLAT_HS_LEAF        7
+#define FLAT_HS_DIM_SHIFT   29
+#define FLAT_HS_INDEX_MASK  ((1U << FLAT_HS_DIM_SHIFT) - 1)
+
+// 8 字节节点: meta 高 3 位是切分维度 (FLAT_HS_LEAF 表示叶子)
+// 内部节点: value 为分割点 (<= value 走左孩子), meta 低 29 位为左孩子下标, 右孩子紧随其后
+// 叶子: value 为规则块在 rule_pool 中的起始下标, meta 低 29 位为规则数
+typedef struct FlatHsNode {
+    uint32_t value;
+    uint32_t meta;
+} FlatHsNode;
+
+// 构建完成后把 HyperSplit 树按广度优先压成数组, 每个叶子的规则按优先级存成 SoA 规则块, 连续放在 rule_pool 中
+class FlatHsTree {
+public:
+    vector<FlatHsNode> nodes;
+    vector<uint32_t> rule_pool;
+
+    template<typename Node> void Build(Node *root);
+    uint32_t Lookup(Trace *trace, ProgramState *ps);
+    uint32_t Lookup(Trace *trace);
+    uint64_t CalMemory();
+};
+
+template<typename Node>
+void FlatHsTree::Build(Node *root) {
+    nodes.clear();
+    rule_pool.clear();
+
+    // 队列下标即节点下标, 兄弟节点同时入队, 所以总是相邻
+    vector<Node*> queue(1, root);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Node *node = queue[head];
+        FlatHsNode flat;
+        if (node->child[0] == NULL) {
+            // 叶子规则数占 29 位, rule_pool 下标是 uint32_t, 超出时直接报错而不是悄悄回绕
+            if (node->rules.size() > FLAT_HS_INDEX_MASK ||
+                rule_pool.size() + RULE_BLOCK_HEAD + node->rules.size() * 11 > UINT32_MAX) {
+                cout << ">>> FlatHsTree::Build -> Wrong! rule_pool overflow, rules_num = " << node->rules.size() << endl;
+                exit(1);
+            }
+            flat.value = AppendRuleBlock(rule_pool, node->rules);
+            flat.meta = ((uint32_t)FLAT_HS_LEAF << FLAT_HS_DIM_SHIFT) | (uint32_t)node->rules.size();
+        } else {
+            if (queue.size() + 1 > FLAT_HS_INDEX_MASK) {
+                cout << ">>> FlatHsTree::Build -> Wrong! too many nodes, nodes_num > " << FLAT_HS_INDEX_MASK << endl;
+                exit(1);
+            }
+            flat.value = node->range[0][1];
+            flat.meta = ((uint32_t)node->dim << FLAT_HS_DIM_SHIFT) | (uint32_t)queue.size();
+            queue.push_back(node->child[0]);
+            queue.push_back(node->child[1]);
+        }
+        nodes.push_back(flat);
+    }
+    nodes.shrink_to_fit();
+    rule_pool.shrink_to_fit();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef  HS_BUILDER_H
+#define  HS_BUILDER_H
+
+#include "../../Elements/Elements.h"
+#include <unordered_set>
+
+using namespace std;
+
+// 裁剪后的规则区间, 用于去重
+struct HsRuleKey {
+    uint32_t range[5][2];
+    bool operator==(const HsRuleKey &key) const { return memcmp(range, key.range, sizeof(range)) == 0; }
+};
+
+struct HsRuleKeyHash {
+    size_t operator()(const HsRuleKey &key) const {
+        uint64_t h = 0x9E3779B97F4A7C15ULL;
+        for (int d = 0; d < 5; ++d) {
+            h = (h ^ (((uint64_t)key.range[d][0] << 32) | key.range[d][1])) * 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+};
+
+// HyperSplit 建树上下文: 节点只记录规则在 rules 中的下标, 裁剪后的区间由原规则与当前节点的 box 求交得到
+// 下标列表按栈分配在 arena 中, 子树建完即回退; 建树结束后整个 builder 释放
+// 规则数达到 TREE_TASK_MIN_RULES 的子树拷贝一份 builder 作为 OpenMP task 构造
+class HsBuilder {
+public:
+    const vector<Rule*> &rules;
+    vector<uint32_t> arena;
+    uint32_t box[5][2];
+    unordered_set<HsRuleKey, HsRuleKeyHash> seen;
+
+    HsBuilder(const vector<Rule*> &_rules) : rules(_rules) {
+        arena.reserve(rules.size() * 4);
+        for (uint32_t i = 0; i < rules.size(); ++i) arena.push_back(i);
+        for (int d = 0; d < 5; ++d) {
+            box[d][0] = 0;
+            box[d][1] = 0xFFFFFFFF;
+        }
+    }
+    // 取 parent.arena 中 begin 之后的下标和当前 box, 供并行构造的子树独立使用
+    HsBuilder(const HsBuilder &parent, size_t begin) : rules(parent.rules) {
+        arena.reserve((parent.arena.size() - begin) * 4);
+        arena.assign(parent.arena.begin() + begin, parent.arena.end());
+        memcpy(box, parent.box, sizeof(box));
+    }
+    uint32_t Lo(uint32_t id, int d) const { return max(rules[id]->range[d][0], box[d][0]); }
+    uint32_t Hi(uint32_t id, int d) const { return min(rules[id]->range[d][1], box[d][1]); }
+
+    // 把 [begin, end) 中落在 dim 维 [low, high] 内的规则 (去重后) 追加到 arena 末尾, 并把 box 收缩到该区间
+    // 返回原来的 box 区间, 子树建完后交给 Restore
+    pair<uint32_t, uint32_t> Split(size_t begin, size_t end, int dim, uint32_t low, uint32_t high, bool remove_redund) {
+        pair<uint32_t, uint32_t> saved(box[dim][0], box[dim][1]);
+        seen.clear();
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t id = arena[i];
+            if (Hi(id, dim) < low || Lo(id, dim) > high) continue;
+            if (remove_redund) {
+                HsRuleKey key;
+                for (int d = 0; d < 5; ++d) {
+                    uint32_t lo = d == dim ? max(box[d][0], low) : box[d][0];
+                    uint32_t hi = d == dim ? min(box[d][1], high) : box[d][1];
+                    key.range[d][0] = max(rules[id]->range[d][0], lo);
+                    key.range[d][1] = min(rules[id]->range[d][1], hi);
+                }
+                if (!seen.insert(key).second) continue;
+            }
+            arena.push_back(id);
+        }
+        box[dim][0] = max(box[dim][0], low);
+        box[dim][1] = min(box[dim][1], high);
+        return saved;
+    }
+    void Restore(size_t begin, int dim, pair<uint32_t, uint32_t> saved) {
+        arena.resize(begin);
+        box[dim][0] = saved.first;
+        box[dim][1] = saved.second;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -27,22 +27,29 @@ HsNode::HsNode(){
 }
 
 void HsNode::Create(vector<Rule*> &rules, ProgramState *ps, int depth) {
-    int rules_num = rules.size();
+	HsBuilder builder(rules);
+	#pragma omp parallel
+	#pragma omp single
+	Build(builder, 0, rules.size(), ps, depth);
+}
+
+void HsNode::Build(HsBuilder &builder, size_t begin, size_t end, ProgramState *ps, int depth) {
+    int rules_num = end - begin;
     if (rules_num == 0) {
 		printf(">>> HsNode::Create -> Wrong! rules_num = 0!\n");
 		exit(1);
 	}
     
 	if (rules_num <= HyperSplit::binth) {
-		this->rules = rules;
+		for (size_t i = begin; i < end; ++i) rules.push_back(builder.rules[builder.arena[i]]);
         ps->DTI.AddNode(depth, rules_num);
 		return;
 	}
 
-    CalHowToCut(rules);
+    CalHowToCut(builder, begin, end);
 
 	if (dim == 255) {
-		this->rules = rules;
+		for (size_t i = begin; i < end; ++i) rules.push_back(builder.rules[builder.arena[i]]);
         ps->DTI.AddNode(depth, rules_num);
 		return;
 	}
@@ -50,41 +57,35 @@ void HsNode::Create(vector<Rule*> &rules, ProgramState *ps, int depth) {
     ps->DTI.AddDims(dim, -1);
 
 	for (int k = 0; k < 2; ++k) {
-		vector<Rule*> child_rules;
-		map<Rule, int> rule_map;
-
-		for (int i = 0; i < rules_num; ++i){
-			if ((k == 0 && rules[i]->range[dim][0] <= range[0][1]) ||
-				(k == 1 && rules[i]->range[dim][1] >= range[1][0])) {
-				Rule* rule_temp = new Rule;
-                rule_temp->SetRule(rules[i]);
-				
-				rule_temp->range[dim][0] = max(rule_temp->range[dim][0], range[k][0]);
-				rule_temp->range[dim][1] = min(rule_temp->range[dim][1], range[k][1]);
-
-				if (!HyperSplit::remove_redund)
-					child_rules.push_back(rule_temp);
-				else if (++rule_map[*rule_temp] <= 1) {
-					child_rules.push_back(rule_temp);
-				}
-			}
-		}
+		size_t child_begin = builder.arena.size();
+		auto saved = builder.Split(begin, end, dim, range[k][0], range[k][1], HyperSplit::remove_redund);
 		
 		child[k] = new HsNode;
-		child[k]->Create(child_rules, ps, depth + 1);
+		if (builder.arena.size() - child_begin >= TREE_TASK_MIN_RULES) {
+			HsNode *node = child[k];
+			HsBuilder *sub = new HsBuilder(builder, child_begin);
+			#pragma omp task firstprivate(node, sub)
+			{
+				node->Build(*sub, 0, sub->arena.size(), ps, depth + 1);
+				delete sub;
+			}
+		} else {
+			child[k]->Build(builder, child_begin, builder.arena.size(), ps, depth + 1);
+		}
+		builder.Restore(child_begin, dim, saved);
 	}
+	#pragma omp taskwait
 	ps->DTI.AddNode(depth);
 }
 
-void HsNode::CalHowToCut(vector<Rule*> &rules){
-	int rules_num = rules.size();
+void HsNode::CalHowToCut(HsBuilder &builder, size_t begin, size_t end){
     double height_avg = 1 << 30;  
 
 	for (int d = 0; d < 5; ++d) {
 		vector<point> points;
-		for (int i = 0; i < rules_num; ++i){
-            points.push_back({rules[i]->range[d][0],0});
-			points.push_back({rules[i]->range[d][1],1});
+		for (size_t i = begin; i < end; ++i){
+            points.push_back({builder.Lo(builder.arena[i], d),0});
+			points.push_back({builder.Hi(builder.arena[i], d),1});
         }
 		sort(points.begin(), points.end());
 
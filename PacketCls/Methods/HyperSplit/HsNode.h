@@ -4,6 +4,7 @@
 #include "../../Elements/Elements.h"
 #include "../../Tools/Tools.h"
 #include "../TreeNode.h"
+#include "HsBuilder.h"
 
 using namespace std;
 
@@ -16,7 +17,8 @@ public:
 
     HsNode();
     void Create(vector<Rule*> &rules, ProgramState *ps, int depth);   
-    void CalHowToCut(vector<Rule*> &rules);                          
+    void Build(HsBuilder &builder, size_t begin, size_t end, ProgramState *ps, int depth);
+    void CalHowToCut(HsBuilder &builder, size_t begin, size_t end);
     uint64_t CalMemory();                                            
     ~HsNode();
 };
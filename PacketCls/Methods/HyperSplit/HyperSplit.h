@@ -5,6 +5,7 @@
 #include "../../Tools/Tools.h"
 #include "../Classifier.h"
 #include "HsNode.h"
+#include "FlatHsTree.h"
 
 using namespace std;
 
@@ -14,6 +15,7 @@ public:
     static bool remove_redund;                             
 
     HsNode *root;      
+    FlatHsTree flat;
     void Create(vector<Rule*> &rules, ProgramState *ps);
     uint32_t Lookup(Trace *trace, ProgramState *ps);
     uint32_t Lookup(Trace *trace);
@@ -61,6 +61,9 @@ void TDEffiNode::Create(ProgramState *ps, int depth) {
     
     if (depth >= _max_depth || rules_num <= _leaf_size) {
         leaf_node = true;      
+        block.Build(rules);
+        // 叶节点查找只读 block, 规则指针数组随即释放, rules_num 仍保留规则数
+        vector<Rule*>().swap(rules);
         ps->DTI.AddNode(depth, rules_num);
         return;                      
     }
@@ -135,6 +138,8 @@ void TDEffiNode::Create(ProgramState *ps, int depth) {
         child_num = 0; 
 
         leaf_node = true; 
+        block.Build(rules);
+        vector<Rule*>().swap(rules);
         ps->DTI.AddNode(depth, rules_num);
         return;
     }
@@ -169,9 +174,11 @@ void TDEffiNode::Create(ProgramState *ps, int depth) {
     
     for (int i = 0; i < child_num; ++i){
         if (vis[i]) {
+            #pragma omp task if (child_arr[i]->rules_num >= TREE_TASK_MIN_RULES)
             child_arr[i]->Create(ps, depth+1); 
         }
     }
+    #pragma omp taskwait
 
     rules.clear();
     ps->DTI.AddNode(depth);
@@ -180,6 +187,7 @@ void TDEffiNode::Create(ProgramState *ps, int depth) {
 uint64_t TDEffiNode::CalMemory() {
 	uint64_t size = sizeof(TDEffiNode);
 	size += rules.capacity() * sizeof(Rule*);
+	size += block.CalMemory();
     if (child_arr != nullptr){
         size += child_num * sizeof(TDEffiNode*);
         map<TDEffiNode*, int> child_map;
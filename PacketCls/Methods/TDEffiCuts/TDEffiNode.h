@@ -23,6 +23,7 @@ public:
 
     TDEffiNode** child_arr;  
     int child_num;              
+    RuleBlock block;       
 
     TDEffiNode();
     void Create(vector<Rule*> &rules, ProgramState *ps, int depth){};  
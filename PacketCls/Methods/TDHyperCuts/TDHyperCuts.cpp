@@ -50,6 +50,8 @@ void TDHyperCuts::Create(vector<Rule*> &rules, ProgramState *ps) {
     root = new TDHcNode;
     root->rules = rules;
     root->rules_num = rules_nums;
+    #pragma omp parallel
+    #pragma omp single
     root->Create(ps, 0);
 }
 
@@ -28,7 +28,14 @@ TDHsNode::TDHsNode(){
 }
 
 void TDHsNode::Create(vector<Rule*> &rules, ProgramState *ps, uint32_t bounds[][2], int depth) {
-    int rules_num = rules.size();
+	HsBuilder builder(rules);
+	#pragma omp parallel
+	#pragma omp single
+	Build(builder, 0, rules.size(), ps, bounds, depth);
+}
+
+void TDHsNode::Build(HsBuilder &builder, size_t begin, size_t end, ProgramState *ps, uint32_t bounds[][2], int depth) {
+    int rules_num = end - begin;
     if (rules_num == 0) {
 		printf(">>> TDHsNode::Create -> Wrong! rules_num = 0!\n");
 		exit(1);
@@ -36,7 +43,7 @@ void TDHsNode::Create(vector<Rule*> &rules, ProgramState *ps, uint32_t bounds[][
     
 	int traces_sum = 0;
 	double pop = 1;
-	if(traceFreqMat2d::mat.nonZeros() != 0){
+	if(traceFreqMat2d::size() != 0){
 		traces_sum = traceFreqMat2d::getTracenum2D(bounds);
 		pop = (TDHyperSplit::total_trace_num * 1.0 / (1 << (depth - 1)));
 		if(pop != 0) pop = traces_sum / pop;
@@ -44,15 +51,15 @@ void TDHsNode::Create(vector<Rule*> &rules, ProgramState *ps, uint32_t bounds[][
 	}
 
 	if (rules_num * pop <= TDHyperSplit::binth) {
-		this->rules = rules;
+		for (size_t i = begin; i < end; ++i) rules.push_back(builder.rules[builder.arena[i]]);
         ps->DTI.AddNode(depth, rules_num);
 		return;
 	}
 
-    CalHowToCut(rules, traces_sum, bounds);
+    CalHowToCut(builder, begin, end, traces_sum, bounds);
 
 	if (dim == 255) {
-		this->rules = rules;
+		for (size_t i = begin; i < end; ++i) rules.push_back(builder.rules[builder.arena[i]]);
         ps->DTI.AddNode(depth, rules_num);
 		return;
 	}
@@ -60,41 +67,39 @@ void TDHsNode::Create(vector<Rule*> &rules, ProgramState *ps, uint32_t bounds[][
     ps->DTI.AddDims(dim, -1);
 
 	for (int k = 0; k < 2; ++k) {
-		vector<Rule*> child_rules;
-		map<Rule, int> rule_map;
-
-		for (int i = 0; i < rules_num; ++i){
-			if ((k == 0 && rules[i]->range[dim][0] <= range[0][1]) ||
-				(k == 1 && rules[i]->range[dim][1] >= range[1][0])) {
-				Rule* rule_temp = new Rule;
-                rule_temp->SetRule(rules[i]);
-				
-				rule_temp->range[dim][0] = max(rule_temp->range[dim][0], range[k][0]);
-				rule_temp->range[dim][1] = min(rule_temp->range[dim][1], range[k][1]);
-
-				if (!TDHyperSplit::remove_redund)
-					child_rules.push_back(rule_temp);
-				else if (++rule_map[*rule_temp] <= 1) {
-					child_rules.push_back(rule_temp);
-				}	
-			}
-		}
+		size_t child_begin = builder.arena.size();
+		auto saved = builder.Split(begin, end, dim, range[k][0], range[k][1], TDHyperSplit::remove_redund);
+
 		if(dim == 0 || dim == 1){
 			swap(range[k][0],bounds[dim][0]);
 			swap(range[k][1],bounds[dim][1]);
 		}
 		child[k] = new TDHsNode;
-		child[k]->Create(child_rules, ps, bounds, depth + 1);
+		if (builder.arena.size() - child_begin >= TREE_TASK_MIN_RULES) {
+			TDHsNode *node = child[k];
+			HsBuilder *sub = new HsBuilder(builder, child_begin);
+			uint32_t (*sub_bounds)[2] = new uint32_t[2][2];
+			memcpy(sub_bounds, bounds, sizeof(uint32_t) * 4);
+			#pragma omp task firstprivate(node, sub, sub_bounds)
+			{
+				node->Build(*sub, 0, sub->arena.size(), ps, sub_bounds, depth + 1);
+				delete sub;
+				delete[] sub_bounds;
+			}
+		} else {
+			child[k]->Build(builder, child_begin, builder.arena.size(), ps, bounds, depth + 1);
+		}
+		builder.Restore(child_begin, dim, saved);
 		if(dim == 0 || dim == 1){
 			swap(range[k][0],bounds[dim][0]);
 			swap(range[k][1],bounds[dim][1]);
 		}
 	}
+	#pragma omp taskwait
 	ps->DTI.AddNode(depth);
 }
 
-void TDHsNode::CalHowToCut(vector<Rule*> &rules, int traces_sum, uint32_t bounds[][2]){
-    int rules_num = rules.size();   
+void TDHsNode::CalHowToCut(HsBuilder &builder, size_t begin, size_t end, int traces_sum, uint32_t bounds[][2]){
     uint64_t height_sum[5];         
 	double height_avgs[5];           
 	vector<cut> cuts[5];		    
@@ -107,9 +112,9 @@ void TDHsNode::CalHowToCut(vector<Rule*> &rules, int traces_sum, uint32_t bounds
 		uniformity[d] = -1;
 
 		vector<point> points;
-		for (int i = 0; i < rules_num; ++i){
-			points.push_back({rules[i]->range[d][0],0});
-			points.push_back({rules[i]->range[d][1],1});
+		for (size_t i = begin; i < end; ++i){
+			points.push_back({builder.Lo(builder.arena[i], d),0});
+			points.push_back({builder.Hi(builder.arena[i], d),1});
         }
 		sort(points.begin(), points.end());
 
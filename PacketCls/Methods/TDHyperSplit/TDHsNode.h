@@ -4,6 +4,7 @@
 #include "../../Elements/Elements.h"
 #include "../../Tools/Tools.h"
 #include "../TreeNode.h"
+#include "../HyperSplit/HsBuilder.h"
 
 using namespace std;
 
@@ -17,7 +18,8 @@ public:
     TDHsNode();
     void Create(vector<Rule*> &rules, ProgramState *ps, int depth){};                
     void Create(vector<Rule*> &rules, ProgramState *ps, uint32_t bounds[][2], int depth);
-    void CalHowToCut(vector<Rule*> &rules, int traces_num, uint32_t bounds[][2]);    
+    void Build(HsBuilder &builder, size_t begin, size_t end, ProgramState *ps, uint32_t bounds[][2], int depth);
+    void CalHowToCut(HsBuilder &builder, size_t begin, size_t end, int traces_num, uint32_t bounds[][2]);
     uint64_t CalMemory();                                                             
     ~TDHsNode();
 };
@@ -29,61 +29,23 @@ void TDHyperSplit::Create(vector<Rule*> &rules, ProgramState *ps) {
 
 	root = new TDHsNode;
     root->Create(rules, ps, bounds, 0);
+
+	// 查找只走扁平化后的数组, 指针树建完即释放
+	flat.Build(root);
+	delete root;
+	root = NULL;
 }
 
 uint32_t TDHyperSplit::Lookup(Trace *trace, ProgramState *ps) {
-	TDHsNode *node = root;
-	while (node->child[0] != NULL) {
-        ps->lookup_access_nodes.Addcount();
-		ps->lookup_access.Addcount();
-
-		if (trace->key[node->dim] <= node->range[0][1])
-			node = node->child[0];
-		else
-			node = node->child[1];
-
-		ps->lookup_depth.Addcount();
-	}
-    ps->lookup_access_nodes.Addcount();
-	ps->lookup_access.Addcount();
-
-	uint32_t ans = 0;
-	for (int i = 0; i < (int)node->rules.size(); ++i) {
-		ps->lookup_access_rules.Addcount();
-		ps->lookup_access.Addcount();
-		
-		if (MatchRuleTrace(node->rules[i], trace)) {
-			ans = node->rules[i]->priority;
-            break;
-		}
-	}
-    ps->lookup_access_nodes.Cal();
-    ps->lookup_access_rules.Cal();
-	ps->lookup_access.Cal();
-	ps->lookup_depth.Cal();
-	return ans;
+	return flat.Lookup(trace, ps);
 }
 
 uint32_t TDHyperSplit::Lookup(Trace *trace) {
-	TDHsNode *node = root;
-	while (node->child[0] != NULL) {
-		if (trace->key[node->dim] <= node->range[0][1])
-			node = node->child[0];
-		else
-			node = node->child[1];
-	}
-	uint32_t ans = 0;
-	for (int i = 0; i < (int)node->rules.size(); ++i) {
-		if (MatchRuleTrace(node->rules[i], trace)) {
-			ans = node->rules[i]->priority;
-            break;
-		}
-	}
-	return ans;
+	return flat.Lookup(trace);
 }
 
 uint64_t TDHyperSplit::CalMemory() {
 	uint64_t memory_size = sizeof(TDHyperSplit);
-	memory_size += root->CalMemory();
+	memory_size += flat.CalMemory();
 	return memory_size;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../../TopK/TopK.h"
 #include "../Classifier.h"
 #include "TDHsNode.h"
+#include "../HyperSplit/FlatHsTree.h"
 
 using namespace std;
 
@@ -19,6 +20,7 @@ public:
     static double pop_min;                                 
     
     TDHsNode *root;                                     
+    FlatHsTree flat;
     void Create(vector<Rule*> &rules, ProgramState *ps);   
     uint32_t Lookup(Trace *trace, ProgramState *ps); 
     uint32_t Lookup(Trace *trace);      
@@ -5,6 +5,9 @@
 
 using namespace std;
 
+// 子节点规则数不少于该值时, 其子树作为 OpenMP task 与兄弟子树并行构造
+#define TREE_TASK_MIN_RULES  256
+
 class TreeNode {
 public:
     virtual void Create(vector<Rule*> &rules, ProgramState *ps, int depth) = 0;   
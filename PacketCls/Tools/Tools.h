@@ -4,6 +4,8 @@
 #include "cmp.h"
 #include "io.h"
 #include "transition.h"
+#include "parallel.h"
 #include "RuleAnalyze.h"
+#include "rule_block.h"
 
 #endif
\ No newline at end of file
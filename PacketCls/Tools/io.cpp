@@ -137,36 +137,37 @@ void PrintRule(Rule* &rule, bool print_priority) {
     printf("\n");
 }
 
-vector<Trace*> ReadTraces(string traces_file) {
+vector<Trace> ReadTraces(string traces_file) {
 	FILE *fp = fopen(traces_file.c_str(), "rb");
 	if (!fp){
         printf("Cannot open the file %s\n", traces_file.c_str());
         exit(0);
     }
 
-	vector<Trace*> traces;
+	vector<Trace> traces;
 	int traces_num = 0;
     char buf[1025];
 
 	while (fgets(buf,1000,fp)!=NULL) { 
         string str = buf;
         vector<string> vc = StrSplit(str, "\t");
-        Trace *trace = (Trace*)malloc(sizeof(Trace));
+        Trace trace;
         for (int i = 0; i < 5; ++i){
-            trace->key[i] = atoi(vc[i].c_str());
+            trace.key[i] = atoi(vc[i].c_str());
         }
         traces.push_back(trace);
         ++traces_num;
     }
+    fclose(fp);
     return traces;
 }
 
-void PrintTraces(vector<Trace*> &traces, string output_file) {
+void PrintTraces(vector<Trace> &traces, string output_file) {
     int traces_num = traces.size();
     FILE *fp = fopen(output_file.c_str(), "w");
     for (int i = 0; i < traces_num; ++i) {
         for(int j = 0; j < 5; ++j){
-            fprintf(fp, "%u\t",traces[i]->key[j]);
+            fprintf(fp, "%u\t",traces[i].key[j]);
         }
         fprintf(fp, "\n");
     }
@@ -9,8 +9,8 @@ vector<Rule*> ReadRules(string output_file, int rules_shuffle);
 
 void PrintRules(vector<Rule*> &rules, string output_file, bool print_priority);
 void PrintRule(Rule* &rule, bool print_priority);
-vector<Trace*> ReadTraces(string traces_file);
-void PrintTraces(vector<Trace*> &traces, string output_file);
+vector<Trace> ReadTraces(string traces_file);
+void PrintTraces(vector<Trace> &traces, string output_file);
 
 
 void PrintTrace(Trace* &trace);
@@ -0,0 +1,51 @@
+#include "parallel.h"
+#include "transition.h"
+
+using namespace std;
+
+int OnlineCores() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+bool PinThreadToCore(int core) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core % OnlineCores(), &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+}
+
+vector<int> ScalingThreadCounts(int max_threads) {
+    vector<int> counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+vector<double> RunPinnedThreads(int threads, function<void(int)> work) {
+    vector<double> times(threads, 0);
+    vector<thread> workers;
+    atomic<int> ready(0);
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            if (!PinThreadToCore(t)) {
+                cout << "PinThreadToCore() : failed to pin thread " << t << endl;
+            }
+            ready++;
+            while (ready.load() < threads) this_thread::yield();
+
+            struct timespec ts_start, ts_end;
+            clock_gettime(CLOCK_MONOTONIC, &ts_start);
+            work(t);
+            clock_gettime(CLOCK_MONOTONIC, &ts_end);
+            times[t] = GetTimeInMicroSeconds(ts_start, ts_end);
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    return times;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef  PARALLEL_H
+#define  PARALLEL_H
+
+#include "../Elements/Elements.h"
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <pthread.h>
+
+using namespace std;
+
+int OnlineCores();
+bool PinThreadToCore(int core);
+vector<int> ScalingThreadCounts(int max_threads);
+
+// 启动 threads 个线程 (第 t 个绑定到核心 t), 同时开始执行 work(t), 返回各线程耗时 (US)
+vector<double> RunPinnedThreads(int threads, function<void(int)> work);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "rule_block.h"
+#include <immintrin.h>
+
+using namespace std;
+
+uint32_t AppendRuleBlock(vector<uint32_t> &pool, const vector<Rule*> &rules) {
+    uint32_t rules_num = rules.size();
+    uint32_t start = pool.size();
+    if (rules_num == 0) return start;
+    pool.resize(start + RuleBlockSize(rules_num), 0);
+
+    uint32_t *block = &pool[start];
+    for (int d = 0; d < 5; ++d) {
+        block[2 * d]     = rules[0]->range[d][0];
+        block[2 * d + 1] = rules[0]->range[d][1];
+    }
+    block[10] = rules[0]->priority;
+
+    block += RULE_BLOCK_HEAD;
+    for (uint32_t i = 0; i < rules_num; ++i) {
+        for (int d = 0; d < 5; ++d) {
+            block[(2 * d) * rules_num + i]     = rules[i]->range[d][0];
+            block[(2 * d + 1) * rules_num + i] = rules[i]->range[d][1];
+        }
+        block[10 * rules_num + i] = rules[i]->priority;
+    }
+    return start;
+}
+
+static int MatchRuleSoAScalar(const uint32_t *soa, uint32_t rules_num, const uint32_t *key) {
+    for (uint32_t i = 0; i < rules_num; ++i) {
+        int d = 0;
+        while (d < 5 && key[d] >= soa[(2 * d) * rules_num + i] && key[d] <= soa[(2 * d + 1) * rules_num + i]) ++d;
+        if (d == 5) return i;
+    }
+    return -1;
+}
+
+// AVX2 没有无符号比较, 用 max/min 等于 key 判断 lo <= key <= hi
+__attribute__((target("avx2")))
+static int MatchRuleSoAAVX2(const uint32_t *soa, uint32_t rules_num, const uint32_t *key) {
+    __m256i k[5];
+    for (int d = 0; d < 5; ++d) k[d] = _mm256_set1_epi32(key[d]);
+
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (uint32_t i = 0; i < rules_num; i += 8) {
+        // 末尾不满 8 条时只加载有效的 lane
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(rules_num - i), lane);
+        __m256i hit = valid;
+        for (int d = 0; d < 5; ++d) {
+            __m256i lo = _mm256_maskload_epi32((const int*)(soa + (2 * d) * rules_num + i), valid);
+            __m256i hi = _mm256_maskload_epi32((const int*)(soa + (2 * d + 1) * rules_num + i), valid);
+            hit = _mm256_and_si256(hit, _mm256_cmpeq_epi32(_mm256_max_epu32(k[d], lo), k[d]));
+            hit = _mm256_and_si256(hit, _mm256_cmpeq_epi32(_mm256_min_epu32(k[d], hi), k[d]));
+            if (_mm256_testz_si256(hit, hit)) break;
+        }
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return -1;
+}
+
+__attribute__((target("avx512f")))
+static int MatchRuleSoAAVX512(const uint32_t *soa, uint32_t rules_num, const uint32_t *key) {
+    __m512i k[5];
+    for (int d = 0; d < 5; ++d) k[d] = _mm512_set1_epi32(key[d]);
+
+    for (uint32_t i = 0; i < rules_num; i += 16) {
+        __mmask16 valid = rules_num - i >= 16 ? 0xFFFF : (__mmask16)((1U << (rules_num - i)) - 1);
+        __mmask16 hit = valid;
+        for (int d = 0; d < 5; ++d) {
+            __m512i lo = _mm512_maskz_loadu_epi32(valid, soa + (2 * d) * rules_num + i);
+            __m512i hi = _mm512_maskz_loadu_epi32(valid, soa + (2 * d + 1) * rules_num + i);
+            hit = _mm512_mask_cmple_epu32_mask(hit, lo, k[d]);
+            hit = _mm512_mask_cmple_epu32_mask(hit, k[d], hi);
+            if (!hit) break;
+        }
+        if (hit) return i + __builtin_ctz(hit);
+    }
+    return -1;
+}
+
+static int (*SelectMatchRuleSoA())(const uint32_t*, uint32_t, const uint32_t*) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return MatchRuleSoAAVX512;
+    if (__builtin_cpu_supports("avx2"))    return MatchRuleSoAAVX2;
+    return MatchRuleSoAScalar;
+}
+
+int (*MatchRuleSoA)(const uint32_t *soa, uint32_t rules_num, const uint32_t *key) = SelectMatchRuleSoA();
+
+const char* RuleBlockIsa() {
+    if (MatchRuleSoA == MatchRuleSoAAVX512) return "avx512";
+    if (MatchRuleSoA == MatchRuleSoAAVX2)   return "avx2";
+    return "scalar";
+}
\ No newline at end of file
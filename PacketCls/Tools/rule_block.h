@@ -0,0 +1,55 @@
+#ifndef  RULE_BLOCK_H
+#define  RULE_BLOCK_H
+
+#include "../Elements/Elements.h"
+
+using namespace std;
+
+#define RULE_BLOCK_HEAD  11
+
+// 叶子规则块: 开头 RULE_BLOCK_HEAD 个 uint32_t 是第一条规则的 lo/hi 交错加 priority (一个 cache line 内),
+// 之后是全部规则的 SoA: lo[0] hi[0] lo[1] hi[1] ... lo[4] hi[4] priority, 每段 rules_num 个 uint32_t
+// 多数报文命中叶子的第一条规则, 先标量检查 head 可以避免为此读取整个 SoA; 向量实现对末尾不满一组的部分使用掩码加载
+inline uint32_t RuleBlockSize(uint32_t rules_num) {
+    return rules_num ? RULE_BLOCK_HEAD + rules_num * 11 : 0;
+}
+
+// 把 rules 按 SoA 块追加到 pool 末尾, 返回块的起始下标
+uint32_t AppendRuleBlock(vector<uint32_t> &pool, const vector<Rule*> &rules);
+
+// SoA 部分的匹配, 启动时按 CPU 选择 AVX-512 / AVX2 / 标量实现
+extern int (*MatchRuleSoA)(const uint32_t *soa, uint32_t rules_num, const uint32_t *key);
+const char* RuleBlockIsa();
+
+// 返回块中第一条命中 key 的规则位置, 没有命中返回 -1
+inline int MatchRuleBlock(const uint32_t *block, uint32_t rules_num, const uint32_t *key) {
+    if (rules_num == 0) return -1;
+    int d = 0;
+    while (d < 5 && key[d] >= block[2 * d] && key[d] <= block[2 * d + 1]) ++d;
+    if (d == 5) return 0;
+    return MatchRuleSoA(block + RULE_BLOCK_HEAD, rules_num, key);
+}
+
+inline uint32_t RuleBlockPriority(const uint32_t *block, uint32_t rules_num, int pos) {
+    return block[RULE_BLOCK_HEAD + rules_num * 10 + pos];
+}
+
+// 节点独立持有的规则块
+class RuleBlock {
+public:
+    vector<uint32_t> data;
+    uint32_t rules_num;
+
+    RuleBlock() { rules_num = 0; }
+    void Build(const vector<Rule*> &rules) {
+        data.clear();
+        rules_num = rules.size();
+        AppendRuleBlock(data, rules);
+        data.shrink_to_fit();
+    }
+    int Match(Trace *trace) const { return MatchRuleBlock(data.data(), rules_num, trace->key); }
+    uint32_t Priority(int pos) const { return RuleBlockPriority(data.data(), rules_num, pos); }
+    uint64_t CalMemory() const { return data.capacity() * sizeof(uint32_t); }
+};
+
+#endif
\ No newline at end of file
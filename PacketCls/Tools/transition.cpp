@@ -36,4 +36,23 @@ string traceToString(Trace *trace) {
     *ptr = static_cast<char>(trace->key[4] & 0xFF);
 
     return result;
+}
+
+void ResetPeakRSS() {
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp == NULL) return;
+    fputs("5", fp);
+    fclose(fp);
+}
+
+double GetPeakRSSInMB() {
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp == NULL) return 0;
+    char line[256];
+    long long kb = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "VmHWM: %lld kB", &kb) == 1) break;
+    }
+    fclose(fp);
+    return kb / 1024.0;
 }
\ No newline at end of file
@@ -9,4 +9,8 @@ double GetTimeInSeconds(struct timespec start, struct timespec end);
 double GetTimeInMicroSeconds(struct timespec start, struct timespec end);
 string traceToString(Trace *trace);
 
+// 进程常驻内存峰值 (/proc/self/status 的 VmHWM, MB); ResetPeakRSS 把峰值重置为当前值, 内核不支持时峰值从进程启动开始算
+void ResetPeakRSS();
+double GetPeakRSSInMB();
+
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #define HK_d 2
 #define HK_b 1.08
+#define HK_DECAY_TABLE_SIZE 512
 
 using namespace std;
 
@@ -19,12 +20,14 @@ public:
 
     BOBHash64 * bobhash; 
     int K, MAX_MEM; 
+    uint64_t rng;   // xorshift64 状态, 代替 rand()
 
 public:
     TDHeavyKeeper(){};
     TDHeavyKeeper(int _K, int _MAX_MEM){
         K = _K;
         MAX_MEM = _MAX_MEM;
+        rng = 0x9E3779B97F4A7C15ULL;
         ss = new TDSSummary(K);
         ss->clear();
         HK = new HKnode*[HK_d];  
@@ -52,6 +55,21 @@ public:
         return (bobhash->run(str.c_str(),str.size()));
     }
 
+    // 与 traceToString 的 13 字节编码相同, 不分配内存
+    unsigned long long Hash(const Trace& trace) {
+        char bytes[13];
+        for (int i = 0; i < 4; ++i) {
+            bytes[i] = static_cast<char>((trace.key[0] >> (24 - 8 * i)) & 0xFF);
+            bytes[4 + i] = static_cast<char>((trace.key[1] >> (24 - 8 * i)) & 0xFF);
+        }
+        bytes[8] = static_cast<char>((trace.key[2] >> 8) & 0xFF);
+        bytes[9] = static_cast<char>(trace.key[2] & 0xFF);
+        bytes[10] = static_cast<char>((trace.key[3] >> 8) & 0xFF);
+        bytes[11] = static_cast<char>(trace.key[3] & 0xFF);
+        bytes[12] = static_cast<char>(trace.key[4] & 0xFF);
+        return bobhash->run(bytes, 13);
+    }
+
     int LOG2(int x){
         int l = 0,r = 31;
         while(l<r){
@@ -66,14 +84,55 @@ public:
         return 1 << x;
     }
 
+    // DECAY[c] = 2^32 / floor(HK_b^c), 32 位随机数小于它的概率即衰减概率
+    static const uint64_t* DECAY() {
+        static uint64_t table[HK_DECAY_TABLE_SIZE];
+        static bool inited = [](){
+            for (int c = 0; c < HK_DECAY_TABLE_SIZE; c++) {
+                double powans = floor(pow(HK_b, c));
+                table[c] = powans < 4294967296.0 ? (1ULL << 32) / (uint64_t)powans : 0;
+            }
+            return true;
+        }();
+        (void)inited;
+        return table;
+    }
+
+    uint32_t RAND() {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        return (uint32_t)(rng >> 32);
+    }
+
     void insert(string str)
     {
+        const unsigned char* ptr = reinterpret_cast<const unsigned char*>(str.data());
+        Trace trace;
+        trace.key[0] = (static_cast<uint32_t>(ptr[0]) << 24) | (static_cast<uint32_t>(ptr[1]) << 16) |
+                       (static_cast<uint32_t>(ptr[2]) << 8)  |  static_cast<uint32_t>(ptr[3]);
+        trace.key[1] = (static_cast<uint32_t>(ptr[4]) << 24) | (static_cast<uint32_t>(ptr[5]) << 16) |
+                       (static_cast<uint32_t>(ptr[6]) << 8)  |  static_cast<uint32_t>(ptr[7]);
+        trace.key[2] = (static_cast<uint32_t>(ptr[8]) << 8)  |  static_cast<uint32_t>(ptr[9]);
+        trace.key[3] = (static_cast<uint32_t>(ptr[10]) << 8) |  static_cast<uint32_t>(ptr[11]);
+        trace.key[4] =  static_cast<uint32_t>(ptr[12]);
+        insert(trace);
+    }
+
+    // 五元组定长 key, 端口按 16 位、协议按 8 位截断 (与字符串编码一致)
+    void insert(const Trace& rawTrace)
+    {
+        Trace trace = rawTrace;
+        trace.key[2] &= 0xFFFF;
+        trace.key[3] &= 0xFFFF;
+        trace.key[4] &= 0xFF;
+
         int maxv=0;
-        unsigned long long H = Hash(str); 
+        unsigned long long H = Hash(trace); 
         int FP= (H>>56); 
 
         bool mon = false;
-        int p = ss->find(str, H);
+        int p = ss->find(trace, H);
         if (p) mon = true; 
 
         for (int j = 0; j < HK_d; j++) {
@@ -87,12 +146,8 @@ public:
                 maxv=max(maxv,HK[j][Hsh].C); 
             } else 
             {
-                int powans = pow(HK_b, HK[j][Hsh].C);
-                if(powans <= 0){
-                    cout<<"pow error! "<<HK_b<<" "<<HK[j][Hsh].C<<" "<<powans<<endl;
-                    exit(1);
-                }
-                if (!(rand() % powans)) 
+                uint64_t threshold = HK[j][Hsh].C < HK_DECAY_TABLE_SIZE ? DECAY()[HK[j][Hsh].C] : 0;
+                if (RAND() < threshold) 
                 {
                     if (HK[j][Hsh].C > 0) { 
                         HK[j][Hsh].C--;
@@ -114,7 +169,7 @@ public:
             {
                 int id = ss->getid(); 
                 ss->addHash(H, id);
-                ss->node[id].str = str;  
+                ss->node[id].trace = trace;  
                 ss->node[id].sum = log_maxv; 
                 ss->node[id].start_sum = maxv;
                 ss->link(0, id); 
@@ -123,7 +178,7 @@ public:
                     int t = ss->getmin(); 
                     int tmp = ss->head[t].id; 
                     ss->cut(ss->head[t].id); 
-                    ss->recycling(tmp, Hash(ss->node[tmp].str));
+                    ss->recycling(tmp, Hash(ss->node[tmp].trace));
                 }
             }
         } else if (log_maxv > ss->node[p].sum) {
@@ -144,22 +199,8 @@ public:
             for(int j = ss->head[i].id; j; j = ss->node[j].nxt) 
             {
                 TraceFreq tmp;
-                const unsigned char* ptr = reinterpret_cast<const unsigned char*>(ss->node[j].str.data());
-
                 tmp.freq = ss->node[j].start_sum;
-                tmp.trace.key[0] =  (static_cast<uint32_t>(ptr[0]) << 24) |
-                                    (static_cast<uint32_t>(ptr[1]) << 16) |
-                                    (static_cast<uint32_t>(ptr[2]) << 8)  |
-                                    (static_cast<uint32_t>(ptr[3]));
-                tmp.trace.key[1] =  (static_cast<uint32_t>(ptr[4]) << 24) |
-                                    (static_cast<uint32_t>(ptr[5]) << 16) |
-                                    (static_cast<uint32_t>(ptr[6]) << 8)  |
-                                    (static_cast<uint32_t>(ptr[7]));
-                tmp.trace.key[2] =  (static_cast<uint32_t>(ptr[8]) << 8)  |
-                                    (static_cast<uint32_t>(ptr[9]));
-                tmp.trace.key[3] =  (static_cast<uint32_t>(ptr[10]) << 8) |
-                                    (static_cast<uint32_t>(ptr[11]));
-                tmp.trace.key[4] =   static_cast<uint32_t>(ptr[12]);
+                tmp.trace = ss->node[j].trace;
 
                 result.push_back(tmp);
             }
@@ -194,7 +235,8 @@ public:
             cout<<ss->head[i].id<<" "<<ss->head[i].left<<" "<<ss->head[i].right<<" "<<endl;
             for(int j = ss->head[i].id; j; j = ss->node[j].nxt) 
             {   
-                cout<<ss->node[j].str<<" "<<ss->node[j].sum<<endl;
+                for (int d = 0; d < 5; ++d) cout<<ss->node[j].trace.key[d]<<" ";
+                cout<<ss->node[j].sum<<endl;
             }
             cout<<"---------------------------------------"<<endl;
         } 
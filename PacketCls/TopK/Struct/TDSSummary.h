@@ -4,9 +4,8 @@
 #include "../../Elements/Elements.h"
 #include "BOBHASH32.h"
 
-#define TD_Max_Hash 9973
+#define TD_Min_Hash 61       // 哈希桶数取 >= 2K 的奇数, 至少 TD_Min_Hash
 #define TD_MAX_FLOW_NUM 64  // maximum flow
-#define TD_MAX_FLOW_SIZE 300  // maximum size of stream-summary
 
 using namespace std;
 
@@ -15,45 +14,54 @@ public:
     int K;         
     int tot;      
     int num;       
-    int ID[TD_MAX_FLOW_SIZE + 10]; 
+    uint32_t max_flow_size;   // stream-summary 容量, 随 K 分配
+    uint32_t hash_size;
+    vector<uint32_t> ID; 
 
     struct headnode{
-        int id;   
+        uint32_t id;   
         int left; 
         int right; 
     } head[TD_MAX_FLOW_NUM + 10];
 
 
     struct linknode{
-        string str; 
+        Trace trace; 
         int sum;    
-        int pre;    
-        int nxt;    
+        uint32_t pre;    
+        uint32_t nxt;    
         int start_sum;
-    } node[TD_MAX_FLOW_SIZE + 10];
+    };
+    vector<linknode> node;
 
 
-    int hhead[TD_Max_Hash + 10]; 
-    int hnext[TD_MAX_FLOW_SIZE + 10];       
+    vector<uint32_t> hhead; 
+    vector<uint32_t> hnext;       
     BOBHash32* bobhash;       
 
     TDSSummary(int _K){
         K = _K;
+        max_flow_size = max(_K, 1) + 2;
+        hash_size = max(2 * _K + 1, TD_Min_Hash);
+        ID.resize(max_flow_size + 10);
+        node.resize(max_flow_size + 10);
+        hhead.resize(hash_size + 10);
+        hnext.resize(max_flow_size + 10);
         bobhash = new BOBHash32(1000);
     }
 
     void clear(){
         K = tot = 0;
-        num = TD_MAX_FLOW_SIZE + 2;
-        for(int i = 1; i <= TD_MAX_FLOW_SIZE + 2; i++) ID[i] = i;
+        num = max_flow_size;
+        for(uint32_t i = 1; i <= max_flow_size; i++) ID[i] = i;
         for(int i = 0; i <= TD_MAX_FLOW_NUM + 9; i++) head[i].id = head[i].left = head[i].right = 0;
-        for(int i = 0; i <= TD_MAX_FLOW_SIZE + 9; i++) {
-            node[i].str = "";
+        for(uint32_t i = 0; i < node.size(); i++) {
+            memset(&node[i].trace, 0, sizeof(Trace));
             node[i].sum = node[i].pre = node[i].nxt = 0;
             node[i].start_sum = 0;
         }
-        memset(hhead,0,sizeof(hhead));
-        memset(hnext,0,sizeof(hnext));
+        fill(hhead.begin(), hhead.end(), 0);
+        fill(hnext.begin(), hnext.end(), 0);
 
         //?为什么要这样 
         head[0].right = TD_MAX_FLOW_NUM;
@@ -68,8 +76,8 @@ public:
             cout<<"TDSSummary id over!"<<endl;
             exit(1);
         }
-        int id = ID[num--];
-        node[id].str = "";
+        uint32_t id = ID[num--];
+        memset(&node[id].trace, 0, sizeof(Trace));
         node[id].sum = node[id].pre = node[id].nxt = 0;
         node[id].start_sum = 0;
         hnext[id]=0;
@@ -77,18 +85,18 @@ public:
     }
 
     int location(unsigned long long H) {
-        return H % TD_Max_Hash;
+        return H % hash_size;
     }
 
-    void addHash(unsigned long long pos,int x) {
+    void addHash(unsigned long long pos, uint32_t x) {
         pos = location(pos);
         hnext[x]=hhead[pos];
         hhead[pos]=x;
     }
 
-    int find(string str, unsigned long long H) {
-        for(int id = hhead[location(H)]; id; id = hnext[id])
-            if(node[id].str == str) 
+    int find(const Trace& trace, unsigned long long H) {
+        for(uint32_t id = hhead[location(H)]; id; id = hnext[id])
+            if(node[id].trace == trace) 
                 return id;
         return 0;
     }
@@ -155,7 +163,7 @@ public:
         if (hhead[pos] == id){
             hhead[pos] = hnext[id];
         } else {
-            for(int j = hhead[pos]; j; j = hnext[j]){
+            for(uint32_t j = hhead[pos]; j; j = hnext[j]){
                 if(hnext[j] == id) {
                     hnext[j] = hnext[id];
                     break;
@@ -171,11 +179,13 @@ public:
         total_memory += sizeof(K);
         total_memory += sizeof(tot);
         total_memory += sizeof(num);
-        total_memory += (TD_MAX_FLOW_SIZE + 10) * sizeof(int);        
+        total_memory += sizeof(max_flow_size);
+        total_memory += sizeof(hash_size);
+        total_memory += ID.size() * sizeof(uint32_t);        
         total_memory += (TD_MAX_FLOW_NUM + 10) * sizeof(headnode);       
-        total_memory += (TD_MAX_FLOW_SIZE + 10) * sizeof(linknode);    
-        total_memory += (TD_Max_Hash + 10) * sizeof(int);          
-        total_memory += (TD_MAX_FLOW_SIZE + 10) * sizeof(int);      
+        total_memory += node.size() * sizeof(linknode);    
+        total_memory += hhead.size() * sizeof(uint32_t);          
+        total_memory += hnext.size() * sizeof(uint32_t);      
         total_memory += sizeof(*bobhash);
 
         return total_memory;
@@ -1,68 +1,81 @@
 #include "traceFreqMat2d.h"
 
-vector<uint32_t> traceFreqMat2d::key[2];
-Eigen::SparseMatrix<uint32_t> traceFreqMat2d::mat;
+vector<uint32_t> traceFreqMat2d::xs;
+vector<vector<uint32_t>> traceFreqMat2d::ys;
+vector<vector<uint64_t>> traceFreqMat2d::sums;
 
 double traceFreqMat2d::getTracenum2D(uint32_t bounds[][2]){
-    uint32_t lid[2],rid[2];
-    for (int d = 0; d < 2; ++d){
-        lid[d] = lower_bound(traceFreqMat2d::key[d].begin(),traceFreqMat2d::key[d].end(),bounds[d][0]) - traceFreqMat2d::key[d].begin();
-        rid[d] = upper_bound(traceFreqMat2d::key[d].begin(),traceFreqMat2d::key[d].end(),bounds[d][1]) - traceFreqMat2d::key[d].begin();
-    }
-    double traces_sum = 0;
-    for(int a = lid[0]; a < rid[0]; a++){
-        for(int b = lid[1]; b < rid[1]; b++){
-            traces_sum += traceFreqMat2d::getValue(a,b);
-        }
+    size_t l = lower_bound(xs.begin(), xs.end(), bounds[0][0]) - xs.begin();
+    size_t r = upper_bound(xs.begin(), xs.end(), bounds[0][1]) - xs.begin();
+
+    uint64_t traces_sum = 0;
+    while (l < r) {
+        // 取从 l 开始、不超过 r 的最大对齐块
+        int level = 0;
+        while (level + 1 < (int)ys.size() && (l & ((2ULL << level) - 1)) == 0 && l + (2ULL << level) <= r) ++level;
+        size_t begin = l;
+        size_t end = l + (1ULL << level);
+
+        const vector<uint32_t> &y = ys[level];
+        const vector<uint64_t> &s = sums[level];
+        size_t a = lower_bound(y.begin() + begin, y.begin() + end, bounds[1][0]) - y.begin();
+        size_t b = upper_bound(y.begin() + begin, y.begin() + end, bounds[1][1]) - y.begin();
+        if (a < b) traces_sum += s[b - 1] - (a == begin ? 0 : s[a - 1]);
+        l = end;
     }
     return traces_sum;
 }
 
 void traceFreqMat2d::init(vector<TraceFreq> &topktraces){
-    set<uint32_t> s[2];
-    int topktraces_num = topktraces.size();
-	for(int i = 0; i < topktraces_num; ++i){
-		for(int d = 0; d < 2; ++d){
-			s[d].insert(topktraces[i].trace.key[d]);
-		}
-	}
-    
-	for(int d = 0; d < 2; ++d){
-		for(auto it : s[d]){
-            traceFreqMat2d::key[d].push_back(it);
-		}
-	}
-    
-    mat.resize(traceFreqMat2d::key[0].size() + 1000, traceFreqMat2d::key[1].size() + 1000);
+    clear();
 
-    uint32_t tkey[2];
-    for(int i = 0; i < topktraces_num; ++i){
-        tkey[0] = topktraces[i].trace.key[0];
-        tkey[1] = topktraces[i].trace.key[1];
-        uint32_t xid = lower_bound(traceFreqMat2d::key[0].begin(),traceFreqMat2d::key[0].end(),tkey[0]) - traceFreqMat2d::key[0].begin();
-        uint32_t yid = lower_bound(traceFreqMat2d::key[1].begin(),traceFreqMat2d::key[1].end(),tkey[1]) - traceFreqMat2d::key[1].begin();
-        traceFreqMat2d::insert(xid, yid, topktraces[i].freq);
-	}
-}
-
-uint64_t traceFreqMat2d::CalMemory() {
-    uint64_t size = 0;
+    // 同一 (src, dst) 只保留最后一次写入的频数
+    map<pair<uint32_t, uint32_t>, uint32_t> cells;
+    for (auto &tf : topktraces) {
+        cells[make_pair(tf.trace.key[0], tf.trace.key[1])] = tf.freq;
+    }
 
-    for (int i = 0; i < 2; ++i) {
-        size += sizeof(key[i]);  
-        size += key[i].capacity() * sizeof(uint32_t); 
+    size_t n = cells.size();
+    vector<pair<uint32_t, uint64_t>> level_points;   // (dst, freq)
+    xs.reserve(n);
+    level_points.reserve(n);
+    for (auto &cell : cells) {
+        xs.push_back(cell.first.first);
+        level_points.push_back(make_pair(cell.first.second, (uint64_t)cell.second));
     }
 
-    size += sizeof(mat);  
-    size += mat.nonZeros() * sizeof(uint32_t); 
-    size += mat.nonZeros() * sizeof(int);              
-    size += mat.outerSize() * sizeof(int);              
+    for (size_t width = 1; ; width <<= 1) {
+        if (width > 1) {
+            for (size_t begin = 0; begin < n; begin += width) {
+                size_t mid = min(begin + width / 2, n);
+                size_t end = min(begin + width, n);
+                inplace_merge(level_points.begin() + begin, level_points.begin() + mid, level_points.begin() + end,
+                              [](const pair<uint32_t, uint64_t> &p1, const pair<uint32_t, uint64_t> &p2) { return p1.first < p2.first; });
+            }
+        }
+        vector<uint32_t> y(n);
+        vector<uint64_t> s(n);
+        for (size_t i = 0; i < n; ++i) {
+            y[i] = level_points[i].first;
+            s[i] = level_points[i].second + (i % width == 0 ? 0 : s[i - 1]);
+        }
+        ys.push_back(move(y));
+        sums.push_back(move(s));
+        if (width >= n) break;
+    }
+}
 
+uint64_t traceFreqMat2d::CalMemory() {
+    uint64_t size = sizeof(xs) + xs.capacity() * sizeof(uint32_t);
+    for (size_t l = 0; l < ys.size(); ++l) {
+        size += sizeof(ys[l]) + ys[l].capacity() * sizeof(uint32_t);
+        size += sizeof(sums[l]) + sums[l].capacity() * sizeof(uint64_t);
+    }
     return size;
 }
 
 void traceFreqMat2d::clear(){
-    traceFreqMat2d::key[0].clear();
-    traceFreqMat2d::key[1].clear();
-    traceFreqMat2d::mat.resize(0, 0);
+    xs.clear();
+    ys.clear();
+    sums.clear();
 }
\ No newline at end of file
@@ -2,22 +2,19 @@
 #define  TRACEFREQMAT2D_H
 
 #include "../../Elements/Elements.h"
-#include <eigen3/Eigen/Dense>
-#include <eigen3/Eigen/Sparse>
 
 using namespace std;
 
+// TopK 报文在 (src, dst) 平面上的频数, 支持任意矩形内的频数和查询
+// 点按 src 排序后建归并树: 第 l 层把数组按 2^l 分块, 块内按 dst 排序并记录块内前缀和
+// 矩形查询把 src 区间拆成 O(log K) 个块, 每块二分 dst 区间, 总计 O(log^2 K)
 class traceFreqMat2d{
 public:
-    static vector<uint32_t> key[2];  
-    static Eigen::SparseMatrix<uint32_t> mat;
+    static vector<uint32_t> xs;               // 按 src 排序的点
+    static vector<vector<uint32_t>> ys;       // ys[l]: 第 l 层块内按 dst 排序
+    static vector<vector<uint64_t>> sums;     // sums[l]: 第 l 层块内到当前位置为止 (含) 的频数和
     static void init(vector<TraceFreq> &topktraces);
-    static void insert(uint32_t row, uint32_t col,uint32_t value){
-        mat.coeffRef(row, col) = value;
-    }
-    static uint32_t getValue(uint32_t row, uint32_t col){
-        return mat.coeff(row, col);
-    }
+    static size_t size() { return xs.size(); }
     static double getTracenum2D(uint32_t bounds[][2]);
     static uint64_t CalMemory();
     static void clear();
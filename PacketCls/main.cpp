@@ -15,7 +15,7 @@ using namespace std;
 
 int rules_num, traces_num;
 vector<Rule*> rules;
-vector<Trace*> traces;
+vector<Trace> traces;
 ProgramState *ps;
 struct timespec ts_start, ts_end; 
 
@@ -29,15 +29,10 @@ int main(int argc, char *argv[]){
     rules_num = rules.size();
     traces_num = traces.size();
 
-    string *trace_str = new string[traces_num + 10];
-    for(int i = 0; i < traces_num; i++){ 
-        trace_str[i] = traceToString(traces[i]);   
-    }   
-
     clock_gettime(CLOCK_MONOTONIC, &ts_start);
     TDHeavyKeeper sketch(Command::topk_num, 0.4 * 1024 * 1024 / 16);
     for(int i = 0; i < traces_num; i++){
-        sketch.insert(trace_str[i]);
+        sketch.insert(traces[i]);
     }   
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
     ps->sketch_build_and_update_time = GetTimeInSeconds(ts_start, ts_end);
@@ -130,10 +125,12 @@ int main(int argc, char *argv[]){
         }
     }
     
+    ResetPeakRSS();
 	clock_gettime(CLOCK_MONOTONIC, &ts_start);
     classifier->Create(rules, ps);
 	clock_gettime(CLOCK_MONOTONIC, &ts_end);
 	ps->tree_build_time = GetTimeInSeconds(ts_start, ts_end);
+	ps->tree_build_peak_rss = GetPeakRSSInMB();
 
     ps->DTI.tree_memory_size = classifier->CalMemory() / 1024.0 / 1024.0;
     if(is_Mat){
@@ -162,7 +159,7 @@ int main(int argc, char *argv[]){
 	for (int k = 0; k < lookup_round; ++k){
 		Ans.clear();
 		for (int i = 0; i < traces_num; ++i){
-            Ans.push_back(classifier->Lookup(traces[i], ps));
+            Ans.push_back(classifier->Lookup(&traces[i], ps));
 		}
 	}
     ps->CalInfo();
@@ -171,12 +168,78 @@ int main(int argc, char *argv[]){
     clock_gettime(CLOCK_MONOTONIC, &ts_start);
     for (int k = 0; k < lookup_round; ++k){
 		for (int i = 0; i < traces_num; ++i){
-            uint32_t tmp = classifier->Lookup(traces[i]);
+            uint32_t tmp = classifier->Lookup(&traces[i]);
 		}
 	}
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
     total_lookup_times += GetTimeInMicroSeconds(ts_start, ts_end);
     ps->avg_lookup_time = total_lookup_times / (lookup_round * traces_num * 1.0);
+    ps->throughput = (traces_num * lookup_round) / (total_lookup_times / 1e6); // pps
+
+    if (Command::ring_size > 0) {
+        // 模拟收包环: 每个 burst 的报文按到达顺序拷进环上连续的槽位, 再对这些槽位批量查找
+        int ring_size = Command::ring_size;
+        int burst = min(Command::batch_size > 0 ? Command::batch_size : 32, ring_size);
+        vector<Trace> ring(ring_size);
+        vector<uint32_t> out(burst);
+        int head = 0, mismatch = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+        for (int k = 0; k < lookup_round; ++k) {
+            for (int i = 0; i < traces_num; i += burst) {
+                int n = min(burst, traces_num - i);
+                if (head + n > ring_size) head = 0;
+                memcpy(&ring[head], &traces[i], n * sizeof(Trace));
+                classifier->LookupBatch(&ring[head], n, out.data());
+                head += n;
+                if (k == 0) {
+                    for (int j = 0; j < n; ++j) mismatch += (out[j] != (uint32_t)Ans[i + j]);
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        ps->ring_size = ring_size;
+        ps->ring_throughput = (traces_num * lookup_round) / (GetTimeInMicroSeconds(ts_start, ts_end) / 1e6); // pps
+        if (mismatch > 0) cout << "ring lookup mismatch " << mismatch << " traces" << endl;
+        cout << "ring lookup over!" << endl;
+    }
+
+    if (Command::threads > 0) {
+        // 每个线程绑定一个核心, 对 traces 的一个分片查询 lookup_round 轮
+        vector<uint64_t> checksum(Command::threads, 0);
+        for (int threads : ScalingThreadCounts(Command::threads)) {
+            vector<double> times = RunPinnedThreads(threads, [&](int tid) {
+                int begin = (long long)traces_num * tid / threads;
+                int end = (long long)traces_num * (tid + 1) / threads;
+                uint64_t sum = 0;
+                for (int k = 0; k < lookup_round; ++k) {
+                    for (int i = begin; i < end; ++i) {
+                        sum += classifier->Lookup(&traces[i]);
+                    }
+                }
+                checksum[tid] += sum;
+            });
+
+            // 总吞吐量按最慢线程的完成时间计算
+            double makespan = 0;
+            vector<double> per_thread(threads, 0);
+            for (int tid = 0; tid < threads; ++tid) {
+                int shard = (long long)traces_num * (tid + 1) / threads - (long long)traces_num * tid / threads;
+                if (times[tid] > 0) per_thread[tid] = (double)shard * lookup_round / times[tid] * 1e6; // pps
+                makespan = max(makespan, times[tid]);
+            }
+            double aggregate = makespan > 0 ? (double)traces_num * lookup_round / makespan * 1e6 : 0; // pps
+            ps->scaling_threads.push_back(threads);
+            ps->scaling_throughput.push_back(aggregate);
+            double base = ps->scaling_throughput[0];
+            ps->scaling_efficiency.push_back(base > 0 ? aggregate / (threads * base) : 0);
+            if (threads == Command::threads) ps->thread_throughput = per_thread;
+        }
+        if (Command::threads > OnlineCores()) {
+            cout << "threads " << Command::threads << " > online cores " << OnlineCores() << ", workers share cores" << endl;
+        }
+        cout << "multi-thread lookup over!" <<endl;
+    }
 
     ps->Print();
     cout<<"Test over!"<<endl;